@@ -0,0 +1,88 @@
+// Compares walking a big arena backed by regular pages against one using ARENA_HUGE_PAGES.
+// Usage: arena_hugepages [size in MB, default 1024]
+
+#define TINYDEF_IMPLEMENTATION
+#include "../tinydef.hpp"
+#include "bench_common.hpp"
+
+#include <stdlib.h>
+
+struct WalkResult {
+	f64 ns;
+	u64 tlbMisses;
+};
+
+static WalkResult sequential_walk(u64* words, size_t count, bench::PerfCounter& tlb) {
+	u64 sum = 0;
+	tlb.start();
+	f64 start = bench::now_ns();
+	for (size_t i = 0; i < count; i++) sum += words[i];
+	f64 end = bench::now_ns();
+	u64 misses = tlb.stop();
+	bench::keep(sum);
+	return { (end - start) / count, misses };
+}
+
+// each word holds the index of the next one to visit, so every load depends on the previous one
+static WalkResult random_walk(u64* words, size_t steps, bench::PerfCounter& tlb) {
+	u64 idx = 0;
+	tlb.start();
+	f64 start = bench::now_ns();
+	for (size_t i = 0; i < steps; i++) idx = words[idx];
+	f64 end = bench::now_ns();
+	u64 misses = tlb.stop();
+	bench::keep(idx);
+	return { (end - start) / steps, misses };
+}
+
+static void run(const char* name, u32 flags, u64 size, bench::PerfCounter& tlb) {
+	mem::Arena arena;
+	arena.alloc(size + mem::HUGE_PAGE_SIZE, flags);
+
+	size_t count = size / sizeof(u64);
+	u64* words = static_cast<u64*>(arena.push(count * sizeof(u64)));
+
+	f64 fillStart = bench::now_ns();
+	for (size_t i = 0; i < count; i++) words[i] = i;
+	f64 fillNs = (bench::now_ns() - fillStart) / count;
+
+	WalkResult seq = sequential_walk(words, count, tlb);
+
+	// Sattolo's shuffle gives a single cycle through every word
+	bench::Rng rng;
+	for (size_t i = count - 1; i > 0; i--) {
+		size_t j = rng.next() % i;
+		u64 tmp = words[i]; words[i] = words[j]; words[j] = tmp;
+	}
+
+	size_t steps = count < 20000000 ? count : 20000000;
+	WalkResult rnd = random_walk(words, steps, tlb);
+
+	printf("%-12s first touch %6.2f ns/word | sequential %6.2f ns/word %8.2f GB/s",
+		name, fillNs, seq.ns, sizeof(u64) / seq.ns);
+	if (tlb.valid()) printf(" %12llu dTLB misses", (unsigned long long)seq.tlbMisses);
+	printf(" | random %7.2f ns/step", rnd.ns);
+	if (tlb.valid()) printf(" %12llu dTLB misses", (unsigned long long)rnd.tlbMisses);
+	printf("\n");
+
+	arena.dealloc();
+}
+
+int main(int argc, char** argv) {
+	u64 sizeMb = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1024;
+	u64 size = sizeMb * 1024 * 1024;
+
+	mem::init();
+
+	bench::PerfCounter tlb;
+	tlb.open_dtlb_misses();
+	if (!tlb.valid()) printf("(perf counters unavailable, only timing will be shown)\n");
+
+	printf("walking %llu MB\n", (unsigned long long)sizeMb);
+	run("4k pages", 0, size, tlb);
+	run("huge pages", mem::ARENA_HUGE_PAGES, size, tlb);
+
+	tlb.close();
+	mem::close();
+	return 0;
+}
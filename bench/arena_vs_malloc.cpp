@@ -0,0 +1,171 @@
+// Compares mem::Arena with malloc/free, new/delete and std::pmr::monotonic_buffer_resource
+// on a few allocation patterns, with every thread using its own allocator.
+// Usage: arena_vs_malloc [operations per thread, default 4000000]
+
+#define TINYDEF_IMPLEMENTATION
+#include "../tinydef.hpp"
+#include "bench_common.hpp"
+
+#include <memory_resource>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+
+// Every allocator gets used the same way: run_batch does a batch of allocations, then everything in the batch is freed.
+// That's an ArenaScope around the batch for the arena, free/delete on every pointer, and release() for the monotonic resource
+struct ArenaBackend {
+	static constexpr const char* name = "mem::Arena";
+	mem::Arena arena;
+
+	ArenaBackend() { arena.alloc(); }
+	~ArenaBackend() { arena.dealloc(); }
+
+	void* alloc(size_t len) { return arena.push_aligned(len, 16); }
+	void* alloc_zero(size_t len) { return memset(arena.push_aligned(len, 16), 0, len); }
+
+	template <typename F>
+	void run_batch(F&& body) {
+		mem::ArenaScope scope(arena);
+		body();
+	}
+};
+
+// Same as above, but zeroing goes through push_zero so the two can be compared
+struct ArenaZeroBackend : ArenaBackend {
+	static constexpr const char* name = "Arena::push_zero";
+	void* alloc_zero(size_t len) { return arena.push_zero(len); }
+};
+
+struct MallocBackend {
+	static constexpr const char* name = "malloc/free";
+	void* ptrs[1024];
+	u32 count = 0;
+
+	void* alloc(size_t len) { return ptrs[count++] = malloc(len); }
+	void* alloc_zero(size_t len) { return ptrs[count++] = calloc(1, len); }
+	void reset() {
+		for (u32 i = 0; i < count; i++) free(ptrs[i]);
+		count = 0;
+	}
+
+	template <typename F>
+	void run_batch(F&& body) {
+		body();
+		reset();
+	}
+};
+
+struct NewBackend {
+	static constexpr const char* name = "new/delete";
+	u8* ptrs[1024];
+	u32 count = 0;
+
+	void* alloc(size_t len) { return ptrs[count++] = new u8[len]; }
+	void* alloc_zero(size_t len) { return ptrs[count++] = new u8[len](); }
+	void reset() {
+		for (u32 i = 0; i < count; i++) delete[] ptrs[i];
+		count = 0;
+	}
+
+	template <typename F>
+	void run_batch(F&& body) {
+		body();
+		reset();
+	}
+};
+
+struct PmrBackend {
+	static constexpr const char* name = "pmr::monotonic";
+	std::pmr::monotonic_buffer_resource resource;
+
+	void* alloc(size_t len) { return resource.allocate(len, 16); }
+	void* alloc_zero(size_t len) { return memset(resource.allocate(len, 16), 0, len); }
+	void reset() { resource.release(); }
+
+	template <typename F>
+	void run_batch(F&& body) {
+		body();
+		reset();
+	}
+};
+
+struct Pattern {
+	const char* name;
+	u32 minSize;
+	u32 maxSize;
+	u32 batch;  // allocations between resets
+	bool zero;
+};
+
+static const Pattern patterns[] = {
+	{ "small pushes (16-64 B)", 16, 64, 1024, false },
+	{ "mixed sizes (16 B-4 KB)", 16, 4096, 256, false },
+	{ "scope loop (8 pushes, release)", 16, 256, 8, false },
+	{ "zeroed (64 B-1 KB)", 64, 1024, 256, true },
+};
+
+template <typename Backend>
+static void worker(const Pattern& pattern, u64 ops, u32 seed) {
+	// sizes are rolled up front so the timing doesn't include the rng
+	static constexpr u32 SIZE_COUNT = 4096;
+	u32 sizes[SIZE_COUNT];
+	bench::Rng rng;
+	rng.state += seed;
+	for (u32 i = 0; i < SIZE_COUNT; i++) {
+		// log-uniform, small sizes are a lot more common than big ones
+		f64 t = (rng.next() >> 11) * (1.0 / 9007199254740992.0);
+		sizes[i] = static_cast<u32>(pattern.minSize * pow(static_cast<f64>(pattern.maxSize) / pattern.minSize, t));
+	}
+
+	Backend allocator;
+	u64 done = 0;
+	while (done < ops) {
+		allocator.run_batch([&]() {
+			for (u32 i = 0; i < pattern.batch; i++, done++) {
+				size_t len = sizes[done & (SIZE_COUNT - 1)];
+				u8* p = static_cast<u8*>(pattern.zero ? allocator.alloc_zero(len) : allocator.alloc(len));
+				p[0] = static_cast<u8>(done);
+				bench::keep(p);
+			}
+		});
+	}
+}
+
+template <typename Backend>
+static void run(const Pattern& pattern, u32 threadCount, u64 ops) {
+	std::vector<std::thread> threads;
+	f64 start = bench::now_ns();
+	for (u32 t = 0; t < threadCount; t++) {
+		threads.emplace_back([&, t]() {
+			worker<Backend>(pattern, ops, t);
+		});
+	}
+	for (std::thread& thread : threads) thread.join();
+	f64 elapsed = bench::now_ns() - start;
+
+	f64 total = static_cast<f64>(ops) * threadCount;
+	printf("    %-18s %8.2f ns/op %10.2f Mops/s\n", Backend::name, elapsed * threadCount / total, total / elapsed * 1000.0);
+}
+
+int main(int argc, char** argv) {
+	u64 ops = argc > 1 ? strtoull(argv[1], nullptr, 10) : 4000000;
+	mem::init();
+
+	u32 maxThreads = std::thread::hardware_concurrency();
+	if (maxThreads == 0) maxThreads = 4;
+
+	for (const Pattern& pattern : patterns) {
+		printf("%s\n", pattern.name);
+		for (u32 threads = 1; threads <= maxThreads; threads *= 2) {
+			printf("  %u thread%s\n", threads, threads == 1 ? "" : "s");
+			run<ArenaBackend>(pattern, threads, ops);
+			if (pattern.zero) run<ArenaZeroBackend>(pattern, threads, ops);
+			run<MallocBackend>(pattern, threads, ops);
+			run<NewBackend>(pattern, threads, ops);
+			run<PmrBackend>(pattern, threads, ops);
+		}
+	}
+
+	mem::close();
+	return 0;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+/* bench_common.hpp
+ * ================
+ * Small helpers shared by the benchmark programs in this folder, include it after tinydef.hpp.
+ * Each benchmark is a single translation unit, build it with something like:
+ *     g++ -O2 -std=c++17 -pthread bench/arena_hugepages.cpp -o arena_hugepages
+ */
+
+#include <chrono>
+#include <stdio.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+	inline f64 now_ns() {
+		using namespace std::chrono;
+		return static_cast<f64>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+	}
+
+	// keeps the compiler from throwing away a result we only computed to time it
+	template <typename T>
+	inline void keep(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile T sink;
+		sink = value;
+#endif
+	}
+
+	// xorshift, good enough to generate random walks and sizes
+	struct Rng {
+		u64 state = 0x9E3779B97F4A7C15ull;
+
+		u64 next() {
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			return state;
+		}
+	};
+
+	// Pins the calling thread to one cpu, so two threads that talk to each other stay on the cores
+	// we picked. Only does something on linux, returns false if the thread couldn't be pinned
+	inline bool pin_thread(u32 cpu) {
+#if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+		(void)cpu;
+		return false;
+#endif
+	}
+
+	// Wraps a single hardware counter through perf_event_open.
+	// If perf isn't available (not linux, or perf_event_paranoid is too strict) valid() is false
+	// and the benchmarks just skip printing the counter
+	struct PerfCounter {
+		int fd = -1;
+
+		void open(u32 type, u64 config) {
+#if defined(__linux__)
+			perf_event_attr attr = {};
+			attr.size = sizeof(attr);
+			attr.type = type;
+			attr.config = config;
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+		}
+
+		// dTLB misses on loads, which is what the arena walks care about
+		void open_dtlb_misses() {
+#if defined(__linux__)
+			open(PERF_TYPE_HW_CACHE,
+				PERF_COUNT_HW_CACHE_DTLB |
+				(PERF_COUNT_HW_CACHE_OP_READ << 8) |
+				(PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+#endif
+		}
+
+		bool valid() const { return fd >= 0; }
+
+		void start() {
+#if defined(__linux__)
+			if (!valid()) return;
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+		}
+
+		u64 stop() {
+			u64 count = 0;
+#if defined(__linux__)
+			if (!valid()) return 0;
+			ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+			if (read(fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+			return count;
+		}
+
+		void close() {
+#if defined(__linux__)
+			if (valid()) ::close(fd);
+#endif
+			fd = -1;
+		}
+	};
+}
@@ -0,0 +1,74 @@
+// Measures how push throughput scales with thread count on one shared arena,
+// comparing ConcurrentArena against an Arena guarded by a mutex.
+// Usage: concurrent_arena [pushes per thread, default 2000000]
+
+#define TINYDEF_IMPLEMENTATION
+#include "../tinydef.hpp"
+#include "bench_common.hpp"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+
+template <typename PushFn>
+static f64 run_threads(u32 threadCount, u64 pushesPerThread, PushFn push) {
+	std::vector<std::thread> threads;
+	std::atomic<u32> ready{ 0 };
+	std::atomic<bool> go{ false };
+
+	for (u32 t = 0; t < threadCount; t++) {
+		threads.emplace_back([&, t]() {
+			bench::Rng rng;
+			rng.state += t;
+			ready.fetch_add(1);
+			while (!go.load(std::memory_order_acquire)) {}
+
+			for (u64 i = 0; i < pushesPerThread; i++) {
+				size_t len = 16 + (rng.next() & 48);
+				u8* p = static_cast<u8*>(push(len));
+				p[0] = static_cast<u8>(i);
+			}
+		});
+	}
+
+	while (ready.load() != threadCount) {}
+	f64 start = bench::now_ns();
+	go.store(true, std::memory_order_release);
+	for (std::thread& thread : threads) thread.join();
+	return bench::now_ns() - start;
+}
+
+int main(int argc, char** argv) {
+	u64 pushes = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000;
+	mem::init();
+
+	u32 maxThreads = std::thread::hardware_concurrency();
+	if (maxThreads == 0) maxThreads = 4;
+
+	printf("%8s %20s %20s\n", "threads", "ConcurrentArena", "Arena + mutex");
+	for (u32 threads = 1; threads <= maxThreads * 2; threads *= 2) {
+		// 64 bytes is the most a single push takes, so this never runs out
+		u64 cap = threads * pushes * 64 + mem::ARENA_COMMIT_CHUNK;
+		u64 total = threads * pushes;
+
+		mem::ConcurrentArena shared;
+		shared.alloc(cap);
+		f64 concurrentNs = run_threads(threads, pushes, [&](size_t len) { return shared.push(len); });
+		shared.dealloc();
+
+		mem::Arena locked;
+		locked.alloc(cap);
+		std::mutex lock;
+		f64 mutexNs = run_threads(threads, pushes, [&](size_t len) {
+			std::lock_guard<std::mutex> guard(lock);
+			return locked.push(len);
+		});
+		locked.dealloc();
+
+		printf("%8u %13.2f Mpush/s %13.2f Mpush/s\n", threads, total / concurrentNs * 1000.0, total / mutexNs * 1000.0);
+	}
+
+	mem::close();
+	return 0;
+}
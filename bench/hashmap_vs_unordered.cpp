@@ -0,0 +1,108 @@
+// tds::HashMap against std::unordered_map with u64 keys, from 1K up to 10M entries.
+// Every size reports insert, lookups that hit, lookups that miss and erase, in ns per operation.
+// Usage: hashmap_vs_unordered [largest size, default 10000000]
+
+#define TINYDEF_IMPLEMENTATION
+#include "../tinydef.hpp"
+#include "bench_common.hpp"
+
+#include <unordered_map>
+#include <vector>
+#include <stdlib.h>
+
+struct Timings {
+	f64 insert;
+	f64 hit;
+	f64 miss;
+	f64 erase;
+};
+
+// keys are shuffled so neither map gets lucky with sequential patterns,
+// misses use keys that were never inserted
+static void make_keys(std::vector<u64>& keys, std::vector<u64>& missing, size_t count) {
+	bench::Rng rng;
+	keys.resize(count);
+	missing.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		keys[i] = rng.next() | 1;
+		missing[i] = rng.next() & ~1ull;
+	}
+}
+
+static Timings run_hashmap(const std::vector<u64>& keys, const std::vector<u64>& missing) {
+	size_t count = keys.size();
+	Timings t;
+
+	mem::Arena arena;
+	arena.alloc(1ull << 36, mem::ARENA_CHAINED);
+	tds::HashMap<u64, u64> map;
+	map.init(arena);
+
+	f64 start = bench::now_ns();
+	for (size_t i = 0; i < count; i++) map.insert(keys[i], i);
+	t.insert = (bench::now_ns() - start) / count;
+
+	u64 sum = 0;
+	start = bench::now_ns();
+	for (size_t i = 0; i < count; i++) sum += *map.find(keys[i]);
+	t.hit = (bench::now_ns() - start) / count;
+
+	start = bench::now_ns();
+	for (size_t i = 0; i < count; i++) sum += map.find(missing[i]) != nullptr;
+	t.miss = (bench::now_ns() - start) / count;
+
+	start = bench::now_ns();
+	for (size_t i = 0; i < count; i++) sum += map.erase(keys[i]);
+	t.erase = (bench::now_ns() - start) / count;
+
+	bench::keep(sum);
+	arena.dealloc();
+	return t;
+}
+
+static Timings run_unordered(const std::vector<u64>& keys, const std::vector<u64>& missing) {
+	size_t count = keys.size();
+	Timings t;
+	std::unordered_map<u64, u64> map;
+
+	f64 start = bench::now_ns();
+	for (size_t i = 0; i < count; i++) map[keys[i]] = i;
+	t.insert = (bench::now_ns() - start) / count;
+
+	u64 sum = 0;
+	start = bench::now_ns();
+	for (size_t i = 0; i < count; i++) sum += map.find(keys[i])->second;
+	t.hit = (bench::now_ns() - start) / count;
+
+	start = bench::now_ns();
+	for (size_t i = 0; i < count; i++) sum += map.find(missing[i]) != map.end();
+	t.miss = (bench::now_ns() - start) / count;
+
+	start = bench::now_ns();
+	for (size_t i = 0; i < count; i++) sum += map.erase(keys[i]);
+	t.erase = (bench::now_ns() - start) / count;
+
+	bench::keep(sum);
+	return t;
+}
+
+static void print(const char* name, const Timings& t) {
+	printf("    %-20s insert %7.2f | hit %7.2f | miss %7.2f | erase %7.2f  (ns/op)\n",
+		name, t.insert, t.hit, t.miss, t.erase);
+}
+
+int main(int argc, char** argv) {
+	size_t largest = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+	mem::init();
+
+	std::vector<u64> keys, missing;
+	for (size_t count = 1000; count <= largest; count *= 10) {
+		make_keys(keys, missing, count);
+		printf("%zu entries\n", count);
+		print("tds::HashMap", run_hashmap(keys, missing));
+		print("std::unordered_map", run_unordered(keys, missing));
+	}
+
+	mem::close();
+	return 0;
+}
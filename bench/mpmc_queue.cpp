@@ -0,0 +1,126 @@
+// Contention sweep for tds::MPMCQueue: every combination of 1 to 32 producers and 1 to 32 consumers
+// (powers of two) passes the same number of messages through one queue. Each message is the time it
+// was pushed, so consumers also measure how long messages sat in the queue, reported as p50/p99/p99.9.
+// Usage: mpmc_queue [messages per run, default 2000000] [batch size, default 1]
+// With a batch size above 1 producers use push_n and consumers try_pop_n
+
+#define TINYDEF_IMPLEMENTATION
+#include "../tinydef.hpp"
+#include "bench_common.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+
+constexpr size_t QUEUE_LEN = 4096;
+constexpr size_t MAX_BATCH = 256;
+constexpr u32 MAX_THREADS = 32;
+// timing every message would mostly measure the clock, so consumers keep one latency out of this many
+constexpr u64 SAMPLE_EVERY = 16;
+
+struct Result {
+	f64 mmsgPerSec;
+	f64 p50;
+	f64 p99;
+	f64 p999;
+};
+
+static Result run(u32 producers, u32 consumers, u64 messages, size_t batch) {
+	mem::Arena arena;
+	arena.alloc(sizeof(tds::MPMCQueue<u64>::Cell) * QUEUE_LEN + mem::ARENA_COMMIT_CHUNK);
+	tds::MPMCQueue<u64> queue;
+	queue.init(arena, QUEUE_LEN);
+
+	u64 perProducer = messages / producers;
+	u64 total = perProducer * producers;
+	std::atomic<u64> consumed(0);
+	std::atomic<u32> ready(0);
+	std::atomic<bool> go(false);
+	std::vector<std::vector<f64>> latencies(consumers);
+	std::vector<std::thread> threads;
+
+	for (u32 p = 0; p < producers; p++) {
+		threads.emplace_back([&]() {
+			u64 buf[MAX_BATCH];
+			ready.fetch_add(1);
+			while (!go.load(std::memory_order_acquire)) {}
+			for (u64 sent = 0; sent < perProducer;) {
+				size_t n = static_cast<size_t>(tim::min<u64>(batch, perProducer - sent));
+				u64 now = static_cast<u64>(bench::now_ns());
+				if (n == 1) {
+					queue.push(now);
+				}
+				else {
+					for (size_t i = 0; i < n; i++) buf[i] = now;
+					queue.push_n(buf, n);
+				}
+				sent += n;
+			}
+		});
+	}
+
+	for (u32 c = 0; c < consumers; c++) {
+		threads.emplace_back([&, c]() {
+			std::vector<f64>& samples = latencies[c];
+			samples.reserve(total / SAMPLE_EVERY / consumers + 1);
+			u64 buf[MAX_BATCH];
+			u64 count = 0;
+			u32 spins = 0;
+			ready.fetch_add(1);
+			while (!go.load(std::memory_order_acquire)) {}
+			// no blocking pop here, once everything is consumed the other consumers would wait forever
+			while (consumed.load(std::memory_order_relaxed) < total) {
+				size_t n = batch == 1 ? queue.try_pop(buf[0]) : queue.try_pop_n(buf, batch);
+				if (!n) {
+					tds::MPMCQueue<u64>::backoff(spins++);
+					continue;
+				}
+				spins = 0;
+				f64 now = bench::now_ns();
+				for (size_t i = 0; i < n; i++) {
+					if (count++ % SAMPLE_EVERY == 0) samples.push_back(now - static_cast<f64>(buf[i]));
+				}
+				consumed.fetch_add(n, std::memory_order_relaxed);
+			}
+		});
+	}
+
+	while (ready.load() != producers + consumers) {}
+	f64 start = bench::now_ns();
+	go.store(true, std::memory_order_release);
+	for (std::thread& thread : threads) thread.join();
+	f64 elapsed = bench::now_ns() - start;
+
+	std::vector<f64> all;
+	for (std::vector<f64>& samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+	std::sort(all.begin(), all.end());
+	auto percentile = [&](f64 p) { return all.empty() ? 0.0 : all[static_cast<size_t>(p * (all.size() - 1))]; };
+
+	Result result;
+	result.mmsgPerSec = total / elapsed * 1000.0;
+	result.p50 = percentile(0.5);
+	result.p99 = percentile(0.99);
+	result.p999 = percentile(0.999);
+	arena.dealloc();
+	return result;
+}
+
+int main(int argc, char** argv) {
+	u64 messages = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000;
+	size_t batch = argc > 2 ? tim::clamp<size_t>(strtoull(argv[2], nullptr, 10), 1, MAX_BATCH) : 1;
+	mem::init();
+
+	printf("%u hardware threads, %llu messages per run, batch size %zu, latencies in ns\n",
+		std::thread::hardware_concurrency(), (unsigned long long)messages, batch);
+	printf("%10s %10s %12s %12s %12s %12s\n", "producers", "consumers", "Mmsg/s", "p50", "p99", "p99.9");
+	for (u32 producers = 1; producers <= MAX_THREADS; producers *= 2) {
+		for (u32 consumers = 1; consumers <= MAX_THREADS; consumers *= 2) {
+			Result r = run(producers, consumers, messages, batch);
+			printf("%10u %10u %12.2f %12.0f %12.0f %12.0f\n", producers, consumers, r.mmsgPerSec, r.p50, r.p99, r.p999);
+		}
+	}
+
+	mem::close();
+	return 0;
+}
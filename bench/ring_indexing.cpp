@@ -0,0 +1,95 @@
+// tds::RingSlice indexing: the plain modulo path against the runtime power of two mask and the
+// compile time length, plus element by element copies against read()/write() with two memcpys.
+// The walk moves through the ring with a stride and keeps wrapping, like a delay line would.
+// Usage: ring_indexing [iterations, default 100000000]
+
+#define TINYDEF_IMPLEMENTATION
+#include "../tinydef.hpp"
+#include "bench_common.hpp"
+
+#include <stdlib.h>
+
+constexpr size_t RING_LEN = 4096;
+constexpr size_t BLOCK_LEN = 256;
+
+// what RingSlice did before it knew about powers of two
+static f64 walk_modulo(f32* data, size_t len, size_t iterations) {
+	f32 sum = 0;
+	f64 start = bench::now_ns();
+	for (size_t i = 0; i < iterations; i++) {
+		i64 pos = static_cast<i64>(i * 7) - 1000;
+		sum += data[tim::circ_idx(pos, static_cast<i64>(len))];
+	}
+	f64 result = (bench::now_ns() - start) / iterations;
+	bench::keep(sum);
+	return result;
+}
+
+template<size_t N>
+static f64 walk_ring(tds::RingSlice<f32, N> ring, size_t iterations) {
+	f32 sum = 0;
+	f64 start = bench::now_ns();
+	for (size_t i = 0; i < iterations; i++) {
+		i64 pos = static_cast<i64>(i * 7) - 1000;
+		sum += ring[pos];
+	}
+	f64 result = (bench::now_ns() - start) / iterations;
+	bench::keep(sum);
+	return result;
+}
+
+template<size_t N>
+static f64 copy_elementwise(tds::RingSlice<f32, N> ring, f32* block, size_t iterations) {
+	size_t blocks = iterations / BLOCK_LEN;
+	f64 start = bench::now_ns();
+	for (size_t b = 0; b < blocks; b++) {
+		i64 pos = static_cast<i64>(b * 100);
+		for (size_t i = 0; i < BLOCK_LEN; i++) ring[pos + i] = block[i];
+		for (size_t i = 0; i < BLOCK_LEN; i++) block[i] = ring[pos + i + 1];
+		bench::keep(block[0]);
+	}
+	return (bench::now_ns() - start) / (blocks * BLOCK_LEN);
+}
+
+template<size_t N>
+static f64 copy_bulk(tds::RingSlice<f32, N> ring, f32* block, size_t iterations) {
+	size_t blocks = iterations / BLOCK_LEN;
+	f64 start = bench::now_ns();
+	for (size_t b = 0; b < blocks; b++) {
+		i64 pos = static_cast<i64>(b * 100);
+		ring.write(block, pos, BLOCK_LEN);
+		ring.read(block, pos + 1, BLOCK_LEN);
+		bench::keep(block[0]);
+	}
+	return (bench::now_ns() - start) / (blocks * BLOCK_LEN);
+}
+
+int main(int argc, char** argv) {
+	size_t iterations = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000000;
+	mem::init();
+
+	mem::Arena arena;
+	arena.alloc(1ull << 24);
+	f32* data = arena.push_array_zero<f32>(RING_LEN);
+	f32* block = arena.push_array_zero<f32>(BLOCK_LEN);
+	for (size_t i = 0; i < RING_LEN; i++) data[i] = static_cast<f32>(i);
+
+	// the length goes through a volatile so the compiler can't see it's a power of two
+	volatile size_t runtimeLen = RING_LEN;
+	tds::RingSlice<f32> dynamicRing{data, runtimeLen};
+	tds::RingSlice<f32, RING_LEN> staticRing{data};
+
+	printf("random access, %zu element ring, ns per access\n", RING_LEN);
+	printf("  modulo          %6.3f\n", walk_modulo(data, runtimeLen, iterations));
+	printf("  runtime pow2    %6.3f\n", walk_ring(dynamicRing, iterations));
+	printf("  compile time    %6.3f\n", walk_ring(staticRing, iterations));
+
+	printf("%zu element block in and out, ns per element\n", BLOCK_LEN);
+	printf("  elementwise     %6.3f\n", copy_elementwise(dynamicRing, block, iterations));
+	printf("  read/write      %6.3f\n", copy_bulk(dynamicRing, block, iterations));
+	printf("  static r/w      %6.3f\n", copy_bulk(staticRing, block, iterations));
+
+	arena.dealloc();
+	mem::close();
+	return 0;
+}
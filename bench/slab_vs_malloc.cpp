@@ -0,0 +1,109 @@
+// Small-object churn on mem::SlabAllocator against the system malloc.
+// A working set of live blocks is kept, and every step frees a random one and allocates a replacement
+// (sometimes through realloc). Every few thousand steps a "request" ends, and the slab allocator
+// is reset while malloc has to free the whole working set one by one.
+// Usage: slab_vs_malloc [steps, default 20000000]
+
+#define TINYDEF_IMPLEMENTATION
+#include "../tinydef.hpp"
+#include "bench_common.hpp"
+
+#include <stdlib.h>
+
+struct SlabBackend {
+	static constexpr const char* name = "SlabAllocator";
+	mem::SlabAllocator slab;
+
+	SlabBackend() { slab.init(); }
+	~SlabBackend() { slab.dealloc(); }
+
+	void* alloc(size_t size) { return slab.alloc(size); }
+	void free(void* ptr) { slab.free(ptr); }
+	void* realloc(void* ptr, size_t size) { return slab.realloc(ptr, size); }
+	// everything the request allocated goes away at once, no need to look at the live pointers
+	void end_request(void**, u32) { slab.reset(); }
+};
+
+struct MallocBackend {
+	static constexpr const char* name = "malloc";
+
+	void* alloc(size_t size) { return ::malloc(size); }
+	void free(void* ptr) { ::free(ptr); }
+	void* realloc(void* ptr, size_t size) { return ::realloc(ptr, size); }
+	void end_request(void** live, u32 count) {
+		for (u32 i = 0; i < count; i++) ::free(live[i]);
+	}
+};
+
+struct Workload {
+	const char* name;
+	u32 maxSize;
+	u32 liveCount;
+	u32 requestLength;  // steps until everything gets thrown away
+};
+
+static const Workload workloads[] = {
+	{ "16-256 B, 1k live", 256, 1024, 10000 },
+	{ "16 B-2 KB, 16k live", 2048, 16384, 100000 },
+	{ "16 B-32 KB, 4k live", 32768, 4096, 50000 },
+};
+
+template <typename Backend>
+static void run(const Workload& workload, u64 steps) {
+	Backend backend;
+	bench::Rng rng;
+	void** live = static_cast<void**>(malloc(sizeof(void*) * workload.liveCount));
+
+	auto roll_size = [&]() {
+		// mostly tiny, now and then something big
+		u64 r = rng.next();
+		u32 shift = static_cast<u32>(r & 7);
+		return static_cast<size_t>(16 + ((r >> 8) % workload.maxSize >> shift));
+	};
+
+	auto fill = [&]() {
+		for (u32 i = 0; i < workload.liveCount; i++) {
+			live[i] = backend.alloc(roll_size());
+			static_cast<u8*>(live[i])[0] = 1;
+		}
+	};
+
+	f64 start = bench::now_ns();
+	fill();
+	for (u64 step = 1; step <= steps; step++) {
+		u64 r = rng.next();
+		u32 idx = static_cast<u32>(r % workload.liveCount);
+		if ((r >> 32) % 8 == 0) {
+			live[idx] = backend.realloc(live[idx], roll_size());
+		}
+		else {
+			backend.free(live[idx]);
+			live[idx] = backend.alloc(roll_size());
+		}
+		static_cast<u8*>(live[idx])[0] = 1;
+
+		if (step % workload.requestLength == 0) {
+			backend.end_request(live, workload.liveCount);
+			fill();
+		}
+	}
+	f64 elapsed = bench::now_ns() - start;
+
+	backend.end_request(live, workload.liveCount);
+	free(live);
+	printf("    %-14s %8.2f ns/op %10.2f Mops/s\n", Backend::name, elapsed / steps, steps / elapsed * 1000.0);
+}
+
+int main(int argc, char** argv) {
+	u64 steps = argc > 1 ? strtoull(argv[1], nullptr, 10) : 20000000;
+	mem::init();
+
+	for (const Workload& workload : workloads) {
+		printf("%s\n", workload.name);
+		run<SlabBackend>(workload, steps);
+		run<MallocBackend>(workload, steps);
+	}
+
+	mem::close();
+	return 0;
+}
@@ -0,0 +1,100 @@
+// Message throughput of tds::SPSCQueue between a producer and a consumer pinned to two cores,
+// one message at a time with try_push/try_pop and in batches with push_n/pop_n.
+// Messages are u64 sequence numbers, the consumer checks that they arrive in order.
+// Usage: spsc_queue [messages, default 200000000] [producer cpu, default 0] [consumer cpu, default 1]
+
+#define TINYDEF_IMPLEMENTATION
+#include "../tinydef.hpp"
+#include "bench_common.hpp"
+
+#include <thread>
+#include <stdlib.h>
+
+constexpr size_t QUEUE_LEN = 1 << 16;
+constexpr size_t MAX_BATCH = 256;
+
+struct Config {
+	u64 messages;
+	u32 producerCpu;
+	u32 consumerCpu;
+};
+
+// batch 1 goes through try_push/try_pop, anything bigger through push_n/pop_n.
+// A side that finds the queue full/empty yields, which only matters when both threads share a core
+static f64 run(const Config& config, size_t batch) {
+	mem::Arena arena;
+	arena.alloc(sizeof(u64) * QUEUE_LEN + mem::ARENA_COMMIT_CHUNK);
+	tds::SPSCQueue<u64> queue;
+	queue.init(arena, QUEUE_LEN);
+
+	std::atomic<bool> go(false);
+	std::thread producer([&]() {
+		bench::pin_thread(config.producerCpu);
+		u64 buf[MAX_BATCH];
+		u64 next = 0;
+		while (!go.load(std::memory_order_acquire)) {}
+		while (next < config.messages) {
+			if (batch == 1) {
+				if (queue.try_push(next)) next++;
+				else std::this_thread::yield();
+				continue;
+			}
+			size_t n = static_cast<size_t>(tim::min<u64>(batch, config.messages - next));
+			for (size_t i = 0; i < n; i++) buf[i] = next + i;
+			size_t pushed = queue.push_n(buf, n);
+			next += pushed;
+			if (!pushed) std::this_thread::yield();
+		}
+	});
+
+	bench::pin_thread(config.consumerCpu);
+	u64 buf[MAX_BATCH];
+	u64 expected = 0;
+	bool inOrder = true;
+	go.store(true, std::memory_order_release);
+	f64 start = bench::now_ns();
+	while (expected < config.messages) {
+		if (batch == 1) {
+			u64 value;
+			if (queue.try_pop(value)) {
+				inOrder &= value == expected;
+				expected++;
+			}
+			else {
+				std::this_thread::yield();
+			}
+			continue;
+		}
+		size_t popped = queue.pop_n(buf, batch);
+		for (size_t i = 0; i < popped; i++) inOrder &= buf[i] == expected + i;
+		expected += popped;
+		if (!popped) std::this_thread::yield();
+	}
+	f64 elapsed = bench::now_ns() - start;
+	producer.join();
+
+	if (!inOrder) printf("messages arrived out of order!\n");
+	arena.dealloc();
+	return config.messages / elapsed * 1000.0;
+}
+
+int main(int argc, char** argv) {
+	Config config;
+	config.messages = argc > 1 ? strtoull(argv[1], nullptr, 10) : 200000000;
+	config.producerCpu = argc > 2 ? static_cast<u32>(atoi(argv[2])) : 0;
+	config.consumerCpu = argc > 3 ? static_cast<u32>(atoi(argv[3])) : 1;
+	mem::init();
+
+	if (std::thread::hardware_concurrency() < 2) {
+		printf("only one cpu, both threads end up sharing it so these numbers mean little\n");
+	}
+	printf("producer on cpu %u, consumer on cpu %u, %llu messages\n",
+		config.producerCpu, config.consumerCpu, (unsigned long long)config.messages);
+	printf("%8s %16s\n", "batch", "Mmsg/s");
+	for (size_t batch = 1; batch <= MAX_BATCH; batch *= 4) {
+		printf("%8zu %16.1f\n", batch, run(config, batch));
+	}
+
+	mem::close();
+	return 0;
+}
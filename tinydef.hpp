@@ -1,546 +1,2982 @@
-#pragma once
-
-/* tinydef.hpp - sandwall
- * ======================
- * This is a header that defines shorthand names for common primitives, useful math constants/functions,
- * simple data structures, as well as memory abstraction data structures.
- */
-
-#if defined(_WIN32)
-#define USING_WIN32
-#elif defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
-#define USING_UNIX
-#endif
-
-#include <stdint.h>
-#include <assert.h>
-
-// i'm not so keen on these includes, will hopefully find a way to get rid of it later
-#include <string.h> // for memset
-#include <math.h>   // for exp and expf
-
-#define TINY_BEGIN_NAMESPACE(name) namespace name {
-#define TINY_END_NAMESPACE }
-
-using i8 = int8_t;
-using u8 = uint8_t;
-using i16 = int16_t;
-using u16 = uint16_t;
-using i32 = int32_t;
-using u32 = uint32_t;
-using i64 = int64_t;
-using u64 = uint64_t;
-using f32 = float;
-using f64 = double;
-using c8 = char;
-using c32 = char32_t;
-
-// TIM = TIny Math
-namespace tim {
-	constexpr f32 pi = 3.1415926535f;
-	constexpr f32 tau = pi * 2.0f;
-
-	constexpr i32 wrap_around(i32 x, i32 max) {
-		if (x >= max) return x % max;
-		if (x < 0) return max + x - 1;
-		return x;
-	}
-
-	template <typename T>
-	constexpr T min(T a, T b) {
-		if (a < b) return a;
-		return b;
-	}
-
-	template <typename T>
-	constexpr T max(T a, T b) {
-		if (a > b) return a;
-		return b;
-	}
-
-	template <typename T>
-	constexpr T clamp(T x, T min, T max) {
-		if (x >= max) return max;
-		if (x <= min) return min;
-		return x;
-	}
-
-	// This function extends clamp to strictly keep a value in between a range
-	// doesn't matter the order of the range arguments
-	template <typename T>
-	constexpr T between(T x, T side1, T side2) {
-		if (side1 == side2) return side1;
-		return (side2 < side1) ?
-			clamp(x, side2, side1) :
-			clamp(x, side1, side2);
-	}
-
-	template<typename T>
-	constexpr T abs(T x) {
-		return x > 0 ? x : -x;
-	}
-
-	// takes a position and a length, and just returns an index into a circular buffer
-	template<typename T>
-	constexpr T circ_idx(T i, T len) {
-		T result = i % len;
-		return result < 0 ? result + len : result;
-	}
-
-	// Frame-independent lerp smoothing - Decay is recommended to be [1,25] from "slow to fast"
-	// thx freya holmer https://youtu.be/LSNQuFEDOyQ?si=mk9QMjab57lxyNkM&t=2978
-	inline f32 filerpf(f32 current, f32 target, f32 decay, f32 dt) {
-		return target + (current - target) * expf(-decay * dt);
-	}
-
-	inline f64 filerp(f64 current, f64 target, f64 decay, f64 dt) {
-		return target + (current - target) * exp(-decay * dt);
-	}
-}
-
-// TDS = Tiny Data Structures
-namespace tds {
-	// this ministruct allows treating data as a circular buffer
-	template<typename T>
-	struct RingSlice {
-		T* data;
-		size_t len;
-
-		T& operator[](i64 i) {
-			return data[tim::circ_idx(i, len)];
-		}
-	};
-
-	// this ministruct allows treating data as a T array
-	template<typename T>
-	struct Slice {
-		T* data;
-		size_t len;
-
-		T& operator[](i64 i) {
-			assert(i >= 0 && i < static_cast<i64>(len));
-			return data[i];
-		}
-	};
-
-	struct StringSlice : public Slice<char> {
-		// checks if the start of the string is equal to some other string
-		bool starts_with(const char* other) {
-			size_t otherLen = strlen(other);
-			if (len < otherLen) return false;
-
-			for (int i = 0; i < otherLen; i++) {
-				if (data[i] != other[i]) return false;
-			}
-
-			return true;
-		}
-
-		// basically shifts the start of the string forwards by n characters
-		void eat_first(size_t n) {
-			size_t actualN = tim::min(n, len);
-
-			data += actualN;
-			len -= actualN;
-		}
-
-		operator char*() { return data; }
-	};
-
-	template<u32 NumBits>
-	struct BitSet {
-		static constexpr u32 SIZE = ((NumBits + 7u) & ~(7u)) / 8;
-		u8 data[SIZE];
-
-		void reset() {
-			memset(data, 0, SIZE);
-		}
-
-		void set(u32 i, bool value) {
-			u32 idx = i / 8;
-			u8 mask = 1u << (i % 8);
-			
-			if (value) data[idx] |= mask;
-			else data[idx] &= ~mask;
-		}
-
-		bool get(u32 i) const {
-			return data[i / 8] & (1 << (i % 8));
-		}
-
-		// I'm implementing this data structure to only be able to get bits with an operater overload
-		// as setting bits with an operator overload requires making a type that is supposed to get returned as a reference
-		// and that reference's constructor will do the settings... a bit complex, so i'll just leave it a regular function
-		bool operator[](u32 i) const { return get(i); }
-	};
-
-	template<typename T>
-	struct LinkedList {
-		struct Node {
-			Node* next;
-			T data;
-		};
-
-		Node start;
-	};
-
-	// simple range struct
-	template<typename T>
-	struct Range {
-		T start;
-		T count;
-	};
-
-	template<u32 Capacity, typename T>
-	struct Stack {
-		static constexpr u32 CAPACITY = Capacity;
-		
-		u32 size;
-		T data[CAPACITY];
-
-		void reset() {
-			memset(data, 0, sizeof(T) * CAPACITY);
-			size = 0;
-		}
-
-		bool push(T t) {
-			assert(size < CAPACITY);
-			data[size++] = t;
-		}
-
-		T pop() {
-			assert(size > 0);
-			return data[size--];
-		}
-
-		T peek(u32 pos) {
-			if (size <= 0) return 0;
-			return data[size - 1];
-		}
-	};
-
-	//template<typename T>
-	//struct Stack {
-	//};
-
-	template<u32 NumStates>
-	struct StateMachine {
-		static constexpr u32 maxStates = NumStates;
-		using StateFunction = void(*)(StateMachine<NumStates>&);
-
-		u32 prevState = 0;
-		u32 state = 0;
-		u32 nextState = 0;
-
-		// These can be set to true in case we want to tell the state machine
-		// to call the enter_state or exit_state functions again for some reason
-		bool signalEnter = false;
-		bool signalExit = false;
-
-		// [i][0] = enter_state
-		// [i][1] = update_state
-		// [i][2] = exit_state
-		StateFunction stateTable[NumStates][3];
-		StateFunction onEnter = nullptr;  // global state enter function
-		StateFunction onExit = nullptr;   // global state exit function
-
-#define ASSERT_STATE_VALIDITY \
-	assert(state < maxStates); \
-	assert(nextState < maxStates);
-
-		void update() {
-			// enter_state is called
-			ASSERT_STATE_VALIDITY
-			if (nextState != state || signalEnter) {
-				StateFunction& sf = stateTable[nextState][0];
-				if (sf) sf(*this);
-				if (onEnter) onEnter(*this);
-
-				signalEnter = false;
-				prevState = state;
-				state = nextState;
-			}
-
-			// update_state (this is expected to change states by setting nextState)
-			ASSERT_STATE_VALIDITY
-			{
-				StateFunction &sf = stateTable[state][1];
-				if (sf) sf(*this);
-			}
-
-			// exit_state
-			// for some reason this isn't getting called when the state is being changed by imgui
-			// (it could be possible that it's not just being ignored for statechanges triggered by imgui)
-			ASSERT_STATE_VALIDITY
-			if (nextState != state || signalExit) {
-				StateFunction& sf = stateTable[state][2];
-				if (sf) sf(*this);
-				if (onExit) onExit(*this);
-
-				signalExit = false;
-			}
-		}
-	};
-}
-
-// Memory utilities
-
-namespace mem {
-	void init();
-	void close();
-	struct Arena& get_scratch();
-
-	// Linear allocator used to group together allocations
-	// On Memory Arenas:
-	// https://www.rfleury.com/p/untangling-lifetimes-the-arena-allocator
-	struct Arena {
-#define push_struct(ptr, struc) push_data(ptr, sizeof(struc))
-		void alloc(u64 cap = 100000000LL); // 100 megabytes
-		void dealloc();
-
-		void clear();
-		void clear_decommit();
-		void* peek();
-		void* push(size_t len);
-		void* push_data(void* pData, size_t sizeData);
-		void* push_zero(size_t len);
-		void pop(size_t len);
-		void pop_to(size_t newPos);
-		
-		template <typename T>
-		T* push() { return (T*)push(sizeof(T)); }
-		template <typename T>
-		T* push_zero() { return (T*)push_zero(sizeof(T)); }
-
-		void* data;
-		size_t pos;
-		size_t capacity;
-	};
-
-	// Helper struct meant to automatically handle temporary allocations
-	// Constructor records the current pos of the arena, and the destructor pops to that old pos
-	struct ArenaScope {
-		ArenaScope(Arena& a, bool automatic = true);
-		~ArenaScope();
-
-		void release();
-
-	private:
-		size_t startPos;
-		Arena& arena;
-
-		bool releaseOnDestruct;
-	};
-
-}
-
-#ifdef TINYDEF_IMPLEMENTATION
-
-#include <assert.h>
-
-#if defined(USING_WIN32)
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
-#elif defined(USING_UNIX)
-#error Memory abstractions not implemented for Unix-type systems!
-#else
-#error Memory abstractions not implemented for this platform!
-#endif
-
-//
-// MEMORY ABSTRACTION IMPLEMENTATION
-//
-
-namespace mem {
-
-	// 4096 is a common page size, but for it to actually be accurate,
-	// we need to set this using information obtained from the OS in mem::init()
-	u64 pageSize = 4096;
-	u64 round_to_page_size(u64 size) {
-		u64 rem = size % pageSize;
-		size -= rem;
-		return size + pageSize;
-	}
-
-#if defined(USING_WIN32)
-	inline u64 get_page_size() {
-		SYSTEM_INFO si = { 0 };
-		GetSystemInfo(&si);
-		return si.dwPageSize;
-	}
-
-	inline void* _reserve(size_t cap) {
-		// maybe round_to_page_size should be used here?
-		return VirtualAlloc(nullptr, cap, MEM_RESERVE, PAGE_READWRITE);
-	}
-
-	inline void* _commit(void* start, size_t size) {
-		return VirtualAlloc(start, size, MEM_COMMIT, PAGE_READWRITE);
-	}
-
-	inline bool _release(void* region) {
-		return VirtualFree(region, 0, MEM_RELEASE);
-	}
-
-#pragma warning(disable : 6250)
-	inline bool _decommit(void* region, size_t size) {
-		return VirtualFree(region, size, MEM_DECOMMIT);
-	}
-
-#elif defined(USING_UNIX)
-	inline u64 get_page_size() {
-		return 4096;
-	}
-
-	inline void* _reserve(size_t cap) {
-		return nullptr;
-	}
-
-	inline void* _commit(void* start, size_t size) {
-		return nullptr;
-	}
-
-	inline bool _release(void* region) {
-		return false;
-	}
-
-	inline bool _decommit(void* region, size_t size) {
-		return false;
-	}
-
-#endif
-
-	//
-	// MEMORY STRUCTURES IMPLEMENTATION
-	// NOTE: Platform specific code is above
-	//
-
-	Arena scratchArena;
-
-	void init() {
-		pageSize = get_page_size();
-		scratchArena.alloc();
-	}
-
-	void close() {
-		scratchArena.dealloc();
-	}
-
-	Arena& get_scratch() {
-		// we're not clearing here anymore since anyone that calls this function
-		// might not specifically want to clear the arena unnecessarily
-
-		// scratchArena.clear();
-		return scratchArena;
-	}
-
-	void Arena::alloc(u64 cap) {
-		// we want to reserve a good spot between "too little" and "holy balls that's too much" memory
-		// when we encounter the problem of this actually being too little memory,
-		// we can probably either raise this size, or start chaining Arenas
-		capacity = round_to_page_size(cap);
-		data = mem::_reserve(capacity);
-
-		// We'll commit the first page of memory, so that we can initially make use of it
-		mem::_commit(data, pageSize);
-	}
-
-	void Arena::dealloc() {
-		// added this, not sure if it's really required
-		clear_decommit();
-		// we can do profiling and testing for that
-
-		capacity = 0;
-		data = nullptr;
-
-		mem::_release(data);
-	}
-
-	// This function is called "peek", and while it might make sense for it to be called that
-	// It's important to remember that the context of this function is to obtain a memory address
-	// to the next spot that can be allocated at. It's useful if you want to initialize an array
-	// by appending to it (this is a less hacky way of doing "data = Arena::push(1); Arena::pop();")
-	void* Arena::peek() {
-		return static_cast<u8*>(data) + pos;
-	}
-
-	// Returns a pointer to len bytes of memory
-	void* Arena::push(size_t len) {
-		assert(pos + len < capacity);
-		_commit(static_cast<u8*>(data) + pos, len);
-		u64 prev = pos;
-		pos += len;
-		return static_cast<u8*>(data) + prev;
-	}
-
-	// Copies pData into the arena and returns a pointer to it
-	void* Arena::push_data(void* pData, size_t sizeData) {
-		assert(pos + sizeData < capacity);
-		_commit(static_cast<u8*>(data) + pos, sizeData);
-		u64 prev = pos;
-		memcpy(static_cast<u8*>(data) + pos, pData, sizeData);
-		pos += sizeData;
-		return static_cast<u8*>(data) + prev;
-	}
-
-	// Returns a pointer to len zero-initialized bytes
-	void* Arena::push_zero(size_t len) {
-		assert(pos + len < capacity);
-		_commit(static_cast<u8*>(data) + pos, len);
-		u64 prev = pos;
-		memset(static_cast<u8*>(data) + pos, 0, len);
-		pos += len;
-		return static_cast<u8*>(data) + prev;
-	}
-
-	// Undoes the most recent len bytes of allocation
-	void Arena::pop(size_t len) {
-		if (len > pos) pos = 0;
-		else pos -= len;
-	}
-
-	// Instead of deallocating the top x bytes in the arena,
-	// we "cut" the allocated bytes to newPos
-	void Arena::pop_to(size_t newPos) {
-		if (newPos > pos) return;
-		pos = newPos;
-	}
-
-	void Arena::clear() {
-		pos = 0;
-	}
-
-	// Decommits all memory except the first page
-	void Arena::clear_decommit() {
-		_decommit(static_cast<u8*>(data) + pageSize, pos - pageSize);
-		clear();
-	}
-
-	/* ArenaScope is handy, and the following example might illustrate why:
-	*
-	*	void bingus(i32 someNumber, Arena& arena) {
-	*		ArenaScope arenaScope(arena);
-	*		u8* bytes = arena.push(someNumber);
-	*
-	*		// do something with bytes...
-	*
-	*		// now, at the end of the scope, arenaScope.~ArenaScope() runs and bytes is freed!
-	*	}
-	*/
-	ArenaScope::ArenaScope(Arena& a, bool automatic)
-		: arena(a), releaseOnDestruct(automatic) {
-		startPos = a.pos;
-	}
-
-	ArenaScope::~ArenaScope() {
-		if(releaseOnDestruct)
-			release();
-	}
-
-	void ArenaScope::release() {
-		arena.pop_to(startPos);
-	}
-
-}
-
-#endif
+#pragma once
+
+/* tinydef.hpp - sandwall
+ * ======================
+ * This is a header that defines shorthand names for common primitives, useful math constants/functions,
+ * simple data structures, as well as memory abstraction data structures.
+ */
+
+#if defined(_WIN32)
+#define USING_WIN32
+#elif defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+#define USING_UNIX
+#endif
+
+#include <stdint.h>
+#include <assert.h>
+
+// i'm not so keen on these includes, will hopefully find a way to get rid of it later
+#include <string.h> // for memset
+#include <math.h>   // for exp and expf
+#include <atomic>   // for ConcurrentArena
+
+// Define TINYDEF_STL (needs C++17) to get allocator adapters that let STL containers live in an Arena
+#ifdef TINYDEF_STL
+#include <memory_resource>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h> // for _BitScanReverse64
+#endif
+
+// std::to_chars gives shortest round-trip float formatting for StringBuilder, when it's available
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <charconv>
+#endif
+#if !defined(__cpp_lib_to_chars)
+#include <stdio.h>  // snprintf fallback for StringBuilder::append_float
+#include <stdlib.h> // strtod
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TINYDEF_SSE2
+#include <emmintrin.h> // for probing HashMap groups
+#endif
+
+#define TINY_BEGIN_NAMESPACE(name) namespace name {
+#define TINY_END_NAMESPACE }
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+using f32 = float;
+using f64 = double;
+using c8 = char;
+using c32 = char32_t;
+
+// TIM = TIny Math
+namespace tim {
+	constexpr f32 pi = 3.1415926535f;
+	constexpr f32 tau = pi * 2.0f;
+
+	constexpr i32 wrap_around(i32 x, i32 max) {
+		if (x >= max) return x % max;
+		if (x < 0) return max + x - 1;
+		return x;
+	}
+
+	template <typename T>
+	constexpr T min(T a, T b) {
+		if (a < b) return a;
+		return b;
+	}
+
+	template <typename T>
+	constexpr T max(T a, T b) {
+		if (a > b) return a;
+		return b;
+	}
+
+	template <typename T>
+	constexpr T clamp(T x, T min, T max) {
+		if (x >= max) return max;
+		if (x <= min) return min;
+		return x;
+	}
+
+	// This function extends clamp to strictly keep a value in between a range
+	// doesn't matter the order of the range arguments
+	template <typename T>
+	constexpr T between(T x, T side1, T side2) {
+		if (side1 == side2) return side1;
+		return (side2 < side1) ?
+			clamp(x, side2, side1) :
+			clamp(x, side1, side2);
+	}
+
+	template<typename T>
+	constexpr T abs(T x) {
+		return x > 0 ? x : -x;
+	}
+
+	// takes a position and a length, and just returns an index into a circular buffer
+	template<typename T>
+	constexpr T circ_idx(T i, T len) {
+		T result = i % len;
+		return result < 0 ? result + len : result;
+	}
+
+	constexpr bool is_pow2(u64 x) {
+		return x && !(x & (x - 1));
+	}
+
+	// circ_idx for when len is a power of two, the mask also gets negative positions right
+	template<typename T>
+	constexpr T circ_idx_pow2(T i, T len) {
+		return i & (len - 1);
+	}
+
+	// index of the highest set bit, x can't be 0
+	inline u32 log2_floor(u64 x) {
+#if defined(_MSC_VER)
+		unsigned long idx;
+		_BitScanReverse64(&idx, x);
+		return idx;
+#else
+		return 63 - __builtin_clzll(x);
+#endif
+	}
+
+	// Frame-independent lerp smoothing - Decay is recommended to be [1,25] from "slow to fast"
+	// thx freya holmer https://youtu.be/LSNQuFEDOyQ?si=mk9QMjab57lxyNkM&t=2978
+	inline f32 filerpf(f32 current, f32 target, f32 decay, f32 dt) {
+		return target + (current - target) * expf(-decay * dt);
+	}
+
+	inline f64 filerp(f64 current, f64 target, f64 decay, f64 dt) {
+		return target + (current - target) * exp(-decay * dt);
+	}
+}
+
+// TDS = Tiny Data Structures
+namespace tds {
+	// The two memcpys behind RingSlice::read/write, first is where the start position lands in the ring
+	template<typename T>
+	void ring_copy_out(T* dst, const T* data, size_t len, size_t first, size_t count) {
+		size_t firstCount = tim::min(count, len - first);
+		memcpy(dst, data + first, sizeof(T) * firstCount);
+		memcpy(dst + firstCount, data, sizeof(T) * (count - firstCount));
+	}
+
+	template<typename T>
+	void ring_copy_in(T* data, const T* src, size_t len, size_t first, size_t count) {
+		size_t firstCount = tim::min(count, len - first);
+		memcpy(data + first, src, sizeof(T) * firstCount);
+		memcpy(data, src + firstCount, sizeof(T) * (count - firstCount));
+	}
+
+	// Pass as N for a RingSlice whose len is set at runtime but is known to always be a power of two
+	constexpr size_t RING_POW2 = ~static_cast<size_t>(0);
+
+	// this ministruct allows treating data as a circular buffer
+	// Giving it a (power of two) length N as a template parameter makes indexing a single AND,
+	// otherwise len is set at runtime and power of two lengths still skip the division
+	template<typename T, size_t N = 0>
+	struct RingSlice {
+		static_assert(tim::is_pow2(N), "a RingSlice with a compile time length needs it to be a power of two");
+		static constexpr size_t len = N;
+
+		T* data;
+
+		size_t wrap(i64 i) const {
+			return static_cast<size_t>(tim::circ_idx_pow2(i, static_cast<i64>(N)));
+		}
+
+		T& operator[](i64 i) {
+			return data[wrap(i)];
+		}
+
+		// Copies count elements starting at start out of the ring, in at most two memcpys
+		void read(T* dst, i64 start, size_t count) {
+			assert(count <= N);
+			ring_copy_out(dst, data, N, wrap(start), count);
+		}
+
+		void write(const T* src, i64 start, size_t count) {
+			assert(count <= N);
+			ring_copy_in(data, src, N, wrap(start), count);
+		}
+	};
+
+	template<typename T>
+	struct RingSlice<T, 0> {
+		T* data;
+		size_t len;
+
+		size_t wrap(i64 i) const {
+			if (tim::is_pow2(len)) return static_cast<size_t>(tim::circ_idx_pow2(i, static_cast<i64>(len)));
+			return static_cast<size_t>(tim::circ_idx(i, static_cast<i64>(len)));
+		}
+
+		T& operator[](i64 i) {
+			return data[wrap(i)];
+		}
+
+		// Copies count elements starting at start out of the ring, in at most two memcpys
+		void read(T* dst, i64 start, size_t count) {
+			assert(count <= len);
+			ring_copy_out(dst, data, len, wrap(start), count);
+		}
+
+		void write(const T* src, i64 start, size_t count) {
+			assert(count <= len);
+			ring_copy_in(data, src, len, wrap(start), count);
+		}
+	};
+
+	// Same as above, minus the power of two check on every access
+	template<typename T>
+	struct RingSlice<T, RING_POW2> {
+		T* data;
+		size_t len;
+
+		size_t wrap(i64 i) const {
+			return static_cast<size_t>(tim::circ_idx_pow2(i, static_cast<i64>(len)));
+		}
+
+		T& operator[](i64 i) {
+			return data[wrap(i)];
+		}
+
+		void read(T* dst, i64 start, size_t count) {
+			assert(count <= len);
+			ring_copy_out(dst, data, len, wrap(start), count);
+		}
+
+		void write(const T* src, i64 start, size_t count) {
+			assert(count <= len);
+			ring_copy_in(data, src, len, wrap(start), count);
+		}
+	};
+
+	// this ministruct allows treating data as a T array
+	template<typename T>
+	struct Slice {
+		T* data;
+		size_t len;
+
+		T& operator[](i64 i) {
+			assert(i >= 0 && i < static_cast<i64>(len));
+			return data[i];
+		}
+	};
+
+	struct StringSlice : public Slice<char> {
+		// checks if the start of the string is equal to some other string
+		bool starts_with(const char* other) {
+			size_t otherLen = strlen(other);
+			if (len < otherLen) return false;
+
+			for (int i = 0; i < otherLen; i++) {
+				if (data[i] != other[i]) return false;
+			}
+
+			return true;
+		}
+
+		// basically shifts the start of the string forwards by n characters
+		void eat_first(size_t n) {
+			size_t actualN = tim::min(n, len);
+
+			data += actualN;
+			len -= actualN;
+		}
+
+		operator char*() { return data; }
+	};
+
+	template<u32 NumBits>
+	struct BitSet {
+		static constexpr u32 SIZE = ((NumBits + 7u) & ~(7u)) / 8;
+		u8 data[SIZE];
+
+		void reset() {
+			memset(data, 0, SIZE);
+		}
+
+		void set(u32 i, bool value) {
+			u32 idx = i / 8;
+			u8 mask = 1u << (i % 8);
+			
+			if (value) data[idx] |= mask;
+			else data[idx] &= ~mask;
+		}
+
+		bool get(u32 i) const {
+			return data[i / 8] & (1 << (i % 8));
+		}
+
+		// I'm implementing this data structure to only be able to get bits with an operater overload
+		// as setting bits with an operator overload requires making a type that is supposed to get returned as a reference
+		// and that reference's constructor will do the settings... a bit complex, so i'll just leave it a regular function
+		bool operator[](u32 i) const { return get(i); }
+	};
+
+	template<typename T>
+	struct LinkedList {
+		struct Node {
+			Node* next;
+			T data;
+		};
+
+		Node start;
+	};
+
+	// simple range struct
+	template<typename T>
+	struct Range {
+		T start;
+		T count;
+	};
+
+	template<u32 Capacity, typename T>
+	struct Stack {
+		static constexpr u32 CAPACITY = Capacity;
+		
+		u32 size;
+		T data[CAPACITY];
+
+		void reset() {
+			memset(data, 0, sizeof(T) * CAPACITY);
+			size = 0;
+		}
+
+		bool push(T t) {
+			assert(size < CAPACITY);
+			data[size++] = t;
+		}
+
+		T pop() {
+			assert(size > 0);
+			return data[size--];
+		}
+
+		T peek(u32 pos) {
+			if (size <= 0) return 0;
+			return data[size - 1];
+		}
+	};
+
+	//template<typename T>
+	//struct Stack {
+	//};
+
+	template<u32 NumStates>
+	struct StateMachine {
+		static constexpr u32 maxStates = NumStates;
+		using StateFunction = void(*)(StateMachine<NumStates>&);
+
+		u32 prevState = 0;
+		u32 state = 0;
+		u32 nextState = 0;
+
+		// These can be set to true in case we want to tell the state machine
+		// to call the enter_state or exit_state functions again for some reason
+		bool signalEnter = false;
+		bool signalExit = false;
+
+		// [i][0] = enter_state
+		// [i][1] = update_state
+		// [i][2] = exit_state
+		StateFunction stateTable[NumStates][3];
+		StateFunction onEnter = nullptr;  // global state enter function
+		StateFunction onExit = nullptr;   // global state exit function
+
+#define ASSERT_STATE_VALIDITY \
+	assert(state < maxStates); \
+	assert(nextState < maxStates);
+
+		void update() {
+			// enter_state is called
+			ASSERT_STATE_VALIDITY
+			if (nextState != state || signalEnter) {
+				StateFunction& sf = stateTable[nextState][0];
+				if (sf) sf(*this);
+				if (onEnter) onEnter(*this);
+
+				signalEnter = false;
+				prevState = state;
+				state = nextState;
+			}
+
+			// update_state (this is expected to change states by setting nextState)
+			ASSERT_STATE_VALIDITY
+			{
+				StateFunction &sf = stateTable[state][1];
+				if (sf) sf(*this);
+			}
+
+			// exit_state
+			// for some reason this isn't getting called when the state is being changed by imgui
+			// (it could be possible that it's not just being ignored for statechanges triggered by imgui)
+			ASSERT_STATE_VALIDITY
+			if (nextState != state || signalExit) {
+				StateFunction& sf = stateTable[state][2];
+				if (sf) sf(*this);
+				if (onExit) onExit(*this);
+
+				signalExit = false;
+			}
+		}
+	};
+}
+
+// Memory utilities
+
+namespace mem {
+	void init();
+	void close();
+	u32 numa_node_count();
+	i32 current_numa_node();
+
+	// Maps the same size bytes of memory twice, back to back, and returns the start of the first copy.
+	// size has to be a multiple of mirror_granularity() (the page size, or 64 KB on windows)
+	void* reserve_mirrored(size_t size);
+	void release_mirrored(void* base, size_t size);
+	size_t mirror_granularity();
+	// Gives the rest of the thread's time slice to whoever else wants to run
+	void yield_thread();
+	struct Arena& get_scratch();
+	struct Arena& get_scratch(struct Arena* const* conflicts, u32 count);
+
+	// Every thread gets this many scratch arenas, reserved the first time the thread asks for one
+	constexpr u32 SCRATCH_COUNT = 2;
+
+	// align must be a power of two
+	constexpr u64 align_up(u64 x, u64 align) { return (x + align - 1) & ~(align - 1); }
+	constexpr u64 align_down(u64 x, u64 align) { return x & ~(align - 1); }
+
+	// Arenas commit memory in steps of this size, so that most pushes don't need to talk to the OS
+	constexpr u64 ARENA_COMMIT_CHUNK = 64 * 1024;
+	constexpr u64 HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+	// Pass this as the alignment to keep hot data that different threads write to on separate cache lines
+	constexpr u64 CACHE_LINE_SIZE = 64;
+
+	enum ArenaFlags : u32 {
+		// Aligns the reservation to HUGE_PAGE_SIZE, commits in huge page steps
+		// and asks the OS to back the arena with transparent huge pages
+		ARENA_HUGE_PAGES = 1 << 0,
+		// Instead of asserting when it runs out of space, the arena reserves a new block
+		// (at least twice as big as the last one) and keeps going from there
+		ARENA_CHAINED = 1 << 1,
+		// Set by alloc_file, the arena is a shared mapping of a file and committing grows the file.
+		// The file starts with a header page that keeps track of pos, so it survives a crash.
+		// Running out of capacity (or failing to grow the file) makes pushes return nullptr
+		ARENA_FILE_BACKED = 1 << 2,
+		// Decommitting uses MADV_FREE where it's available, so the OS only takes the pages back
+		// when it actually needs the memory (RSS stays high until then)
+		ARENA_LAZY_DECOMMIT = 1 << 3,
+		// Pages get faulted in as soon as they're committed, so the page faults all happen inside the
+		// (already slow) commit instead of at random pushes. Pair it with a bigger commitChunk to commit further ahead
+		ARENA_PREFAULT = 1 << 4,
+		// Places the arena's memory on the NUMA node of the thread calling alloc (see Arena::bind_numa)
+		ARENA_NUMA_LOCAL = 1 << 5,
+	};
+
+#ifdef TINYDEF_ARENA_STATS
+	// Define TINYDEF_ARENA_STATS to have every Arena keep track of how it is used,
+	// without it none of this exists and the arena code doesn't do any extra work.
+	// Stats are updated by whoever pushes to the arena, so reading them from another thread is only approximate
+	struct ArenaStats {
+		const char* name;       // shows up in dump_arena_stats, can be set after alloc, has to outlive the arena
+		size_t peakPos;
+		size_t committedBytes;  // across every block of a chained arena
+		u64 commitCalls;
+		u64 decommitCalls;      // includes chained blocks being released
+		u64 pushCount;
+		u64 sizeHistogram[64];  // [i] counts pushes with a length in [2^i, 2^(i+1)), zero-length pushes go in [0]
+
+		// every allocated arena is in a list so they can all be dumped at once,
+		// which means an arena shouldn't be copied or moved between alloc and dealloc
+		struct Arena* prevLive;
+		struct Arena* nextLive;
+	};
+
+	// Prints the stats of every arena that is currently allocated (on any thread) to stdout
+	void dump_arena_stats();
+#endif
+
+	// Linear allocator used to group together allocations
+	// On Memory Arenas:
+	// https://www.rfleury.com/p/untangling-lifetimes-the-arena-allocator
+	struct Arena {
+#define push_struct(ptr, struc) push_data(ptr, sizeof(struc))
+		void alloc(u64 cap = 100000000LL, u32 arenaFlags = 0); // 100 megabytes
+		bool alloc_file(const char* path, u64 cap = 100000000LL);
+		void dealloc();
+		bool bind_numa(i32 node);
+
+		void clear();
+		void clear_decommit();
+		void decommit_above(size_t end);
+		void set_decommit_policy(size_t slack, u32 afterReleases);
+		void* peek();
+		void* push(size_t len);
+		void* push_aligned(size_t len, size_t align);
+		void* push_data(void* pData, size_t sizeData);
+		void* push_zero(size_t len);
+		void pop(size_t len);
+		void pop_to(size_t newPos);
+		bool is_top(const void* ptr, size_t len);
+		bool try_extend(void* ptr, size_t len, size_t extra);
+		bool commit_to(size_t end);
+		void prefault(size_t end);
+		void chain(size_t len);
+		
+		// The typed versions respect alignof(T), the byte versions above don't do any alignment
+		template <typename T>
+		T* push() { return (T*)push_aligned(sizeof(T), alignof(T)); }
+		template <typename T>
+		T* push_zero() { return (T*)push_array_zero<T>(1); }
+		template <typename T>
+		T* push_array(size_t n, size_t align = alignof(T)) { return (T*)push_aligned(sizeof(T) * n, align); }
+		template <typename T>
+		T* push_array_zero(size_t n, size_t align = alignof(T)) {
+			void* result = push_aligned(sizeof(T) * n, align);
+			return (T*)(result ? memset(result, 0, sizeof(T) * n) : nullptr);
+		}
+
+		// data, capacity and committed describe the block currently being pushed to,
+		// while pos counts up across all blocks so it can be used with pop_to and ArenaScope
+		void* data;
+		size_t pos;
+		size_t capacity;
+		size_t committed;   // everything below this (relative to data) is already committed
+		size_t commitChunk; // how much gets committed at once, can be changed after alloc
+		size_t basePos;     // what pos would be at data[0], only non-zero for chained blocks and file backed arenas
+		struct ArenaBlock* prevBlock;
+		u32 flags;
+		intptr_t file;      // file descriptor (or HANDLE on windows) of a file backed arena
+		i32 numaNode;       // -1 leaves placement up to the OS (first touch)
+
+		// see set_decommit_policy
+		size_t decommitSlack;
+		u32 decommitAfter;  // 0 turns the policy off
+		u32 lowReleases;
+		size_t windowPeak;  // highest offset used in the current block since the policy last looked
+
+#ifdef TINYDEF_ARENA_STATS
+		ArenaStats stats;
+#endif
+	};
+
+	// Helper struct meant to automatically handle temporary allocations
+	// Constructor records the current pos of the arena, and the destructor pops to that old pos
+	struct ArenaScope {
+		ArenaScope(Arena& a, bool automatic = true);
+		~ArenaScope();
+
+		void release();
+
+	private:
+		size_t startPos;
+		Arena& arena;
+
+		bool releaseOnDestruct;
+	};
+
+	// N arenas that take turns being the current frame's arena in a tick loop. begin_frame() moves on to the
+	// next one and clears it, so everything allocated during a frame stays valid for the N - 1 frames after it.
+	// With the default of 2 that means the previous frame's data can still be read while the current one runs
+	template <u32 N = 2>
+	struct FrameArenas {
+		static_assert(N >= 2, "with a single arena nothing would survive into the next frame");
+
+		// retain is how much memory (from the start of each arena) stays committed when it gets reused,
+		// anything past it that an unusually big frame committed is given back to the OS.
+		// The default of SIZE_MAX never decommits
+		void alloc(u64 cap = 100000000LL, u32 arenaFlags = 0, size_t retainBytes = SIZE_MAX) {
+			for (Arena& arena : arenas) arena.alloc(cap, arenaFlags);
+			frame = 0;
+			retain = retainBytes;
+		}
+
+		void dealloc() {
+			for (Arena& arena : arenas) arena.dealloc();
+		}
+
+		Arena& begin_frame() {
+			frame = (frame + 1) % N;
+			Arena& arena = arenas[frame];
+			arena.clear();
+			if (retain != SIZE_MAX) arena.decommit_above(retain);
+			return arena;
+		}
+
+		Arena& current() { return arenas[frame]; }
+
+		// The arena of a frame that already ended, framesAgo has to be less than N
+		const Arena& previous(u32 framesAgo = 1) const {
+			assert(framesAgo > 0 && framesAgo < N);
+			return arenas[(frame + N - framesAgo) % N];
+		}
+
+		Arena arenas[N];
+		u32 frame;
+		size_t retain;
+	};
+
+	// Arena that any number of threads can push to at the same time. Space is claimed with an atomic add on pos,
+	// and the first thread that needs memory past the committed mark does the OS call while the others wait for it.
+	// There is no chaining and no popping, the whole thing can only be cleared once every thread is done pushing.
+	// Running out of space makes push return nullptr instead of asserting, since threads race past the end together
+	struct ConcurrentArena {
+		void alloc(u64 cap = 100000000LL, u32 arenaFlags = 0); // 100 megabytes
+		void dealloc();
+
+		void clear();
+		void* push(size_t len);
+		void* push_aligned(size_t len, size_t align);
+		void* push_zero(size_t len);
+		bool commit_to(size_t end);
+
+		template <typename T>
+		T* push() { return (T*)push_aligned(sizeof(T), alignof(T)); }
+		template <typename T>
+		T* push_array(size_t n, size_t align = alignof(T)) { return (T*)push_aligned(sizeof(T) * n, align); }
+
+		void* data;
+		size_t capacity;
+		size_t commitChunk;
+		u32 flags;
+
+		// pos gets hammered by every pushing thread, so it gets a cache line to itself
+		alignas(CACHE_LINE_SIZE) std::atomic<size_t> pos;
+		alignas(CACHE_LINE_SIZE) std::atomic<size_t> committed;
+		std::atomic<bool> committing;
+	};
+
+	// Allocator for objects of one type that come and go in any order (which an Arena can't do by itself).
+	// Slots are pushed onto the arena a slab at a time, and freed slots get reused through a free list
+	// that is stored inside of the free slots, so after warming up alloc and free never touch the arena.
+	// Define TINYDEF_POOL_CHECKS to make every slot remember if it's in use, which catches double frees
+	template <typename T>
+	struct Pool {
+		struct Slot {
+			union {
+				Slot* next;
+				alignas(T) u8 storage[sizeof(T)];
+			};
+#ifdef TINYDEF_POOL_CHECKS
+			bool live;
+#endif
+		};
+
+		void init(Arena& a, u32 slotsPerSlab = 64) {
+			arena = &a;
+			freeList = nullptr;
+			slab = nullptr;
+			slabUsed = slotsPerSlab;
+			slabSize = slotsPerSlab;
+		}
+
+		T* alloc() {
+			Slot* slot = freeList;
+			if (slot) {
+				freeList = slot->next;
+			}
+			else {
+				if (slabUsed == slabSize) {
+					slab = arena->push_array<Slot>(slabSize);
+					slabUsed = 0;
+#ifdef TINYDEF_POOL_CHECKS
+					for (u32 i = 0; i < slabSize; i++) slab[i].live = false;
+#endif
+				}
+				slot = &slab[slabUsed++];
+			}
+
+#ifdef TINYDEF_POOL_CHECKS
+			assert(!slot->live);
+			slot->live = true;
+#endif
+			return reinterpret_cast<T*>(slot->storage);
+		}
+
+		T* alloc_zero() { return (T*)memset(alloc(), 0, sizeof(T)); }
+
+		void free(T* ptr) {
+			// the storage is at the start of the slot, so the pointer we handed out is the slot
+			Slot* slot = reinterpret_cast<Slot*>(ptr);
+#ifdef TINYDEF_POOL_CHECKS
+			// if this fires, ptr was already freed (or didn't come from this pool)
+			assert(slot->live);
+			slot->live = false;
+#endif
+			slot->next = freeList;
+			freeList = slot;
+		}
+
+		Arena* arena;
+		Slot* freeList;
+		Slot* slab;     // slab that new slots are taken from when the free list is empty
+		u32 slabUsed;
+		u32 slabSize;
+	};
+
+	// General purpose alloc/free/realloc for lots of small objects, meant to be used by one thread.
+	// Requests up to MAX_SIZE are rounded up to a size class (16 byte steps up to 128, then 4 steps per power of two),
+	// and every class takes its blocks from its own slabs, which are pushed onto a private arena.
+	// Bigger requests get their own reservation straight from the OS.
+	// reset() throws everything away at once, so memory from one request never fragments the next one
+	struct SlabAllocator {
+		static constexpr size_t MAX_SIZE = 32 * 1024;
+		static constexpr size_t SLAB_SIZE = 256 * 1024; // slabs are aligned to this, so the slab header is found by masking
+		static constexpr size_t SLAB_HEADER = 64;
+		static constexpr u32 CLASS_COUNT = 40;
+
+		void init(u64 cap = 1ull << 32); // 4 gigabytes of address space for slabs
+		void dealloc();
+		void reset();
+
+		void* alloc(size_t size);
+		void free(void* ptr);
+		void* realloc(void* ptr, size_t size);
+		size_t usable_size(void* ptr);
+
+		static u32 size_class(size_t size);
+		static size_t class_size(u32 sizeClass);
+
+		struct FreeBlock {
+			FreeBlock* next;
+		};
+
+		struct SizeClass {
+			FreeBlock* freeList;
+			u8* bumpPos;  // blocks that were never handed out in the newest slab of this class
+			u8* bumpEnd;
+		};
+
+		// sits in front of every large allocation, they're kept in a list so reset() can release them
+		struct LargeHeader {
+			LargeHeader* prev;
+			LargeHeader* next;
+			size_t reserved;
+			size_t size;
+		};
+
+		Arena arena;
+		SizeClass classes[CLASS_COUNT];
+		LargeHeader* largeList;
+	};
+
+#ifdef TINYDEF_STL
+	// Memory resource for std::pmr containers, e.g. std::pmr::vector<int> v(&resource);
+	// Deallocating only gives the memory back if it's the most recent allocation in the arena
+	struct ArenaResource : std::pmr::memory_resource {
+		explicit ArenaResource(Arena& a) : arena(a) {}
+
+		Arena& arena;
+
+	protected:
+		void* do_allocate(size_t bytes, size_t align) override {
+			return arena.push_aligned(bytes, align);
+		}
+
+		void do_deallocate(void* ptr, size_t bytes, size_t align) override {
+			if (arena.is_top(ptr, bytes)) arena.pop(bytes);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+			const ArenaResource* otherArena = dynamic_cast<const ArenaResource*>(&other);
+			return otherArena && &otherArena->arena == &arena;
+		}
+	};
+
+	// Same idea for containers that take an allocator type, e.g.
+	// std::vector<int, mem::ArenaAllocator<int>> v(mem::ArenaAllocator<int>(arena));
+	template <typename T>
+	struct ArenaAllocator {
+		using value_type = T;
+
+		ArenaAllocator(Arena& a) : arena(&a) {}
+		template <typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+		T* allocate(size_t n) { return arena->push_array<T>(n); }
+		void deallocate(T* ptr, size_t n) {
+			if (arena->is_top(ptr, sizeof(T) * n)) arena->pop(sizeof(T) * n);
+		}
+
+		template <typename U>
+		bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+		template <typename U>
+		bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+		Arena* arena;
+	};
+#endif
+
+	// Pointer stored as an offset from its own address, so that a structure built out of these still works
+	// when the memory it lives in shows up at a different address (like with load_snapshot).
+	// Copying one has to go through the constructor/operators since the offset depends on where it's stored
+	template <typename T>
+	struct RelPtr {
+		RelPtr() : offset(0) {}
+		RelPtr(T* ptr) { set(ptr); }
+		RelPtr(const RelPtr& other) { set(other.get()); }
+
+		RelPtr& operator=(const RelPtr& other) { set(other.get()); return *this; }
+		RelPtr& operator=(T* ptr) { set(ptr); return *this; }
+
+		// an offset of 0 is null, so a RelPtr can't point at itself
+		void set(T* ptr) {
+			offset = ptr ? static_cast<i64>(reinterpret_cast<intptr_t>(ptr) - reinterpret_cast<intptr_t>(this)) : 0;
+		}
+
+		T* get() const {
+			return offset ? reinterpret_cast<T*>(reinterpret_cast<intptr_t>(this) + offset) : nullptr;
+		}
+
+		T* operator->() const { return get(); }
+		T& operator*() const { return *get(); }
+		explicit operator bool() const { return offset != 0; }
+
+		i64 offset;
+	};
+
+	// Snapshots write out [data, data + pos) of an arena, so it can be mapped back in later without any parsing.
+	// Anything in the arena that points into the arena has to be a RelPtr (or an offset) for this to work.
+	// The data starts SNAPSHOT_HEADER_SIZE bytes into the file, so alignments up to that are kept
+	constexpr u64 SNAPSHOT_MAGIC = 0x31304E5053544454ull; // "TDTSPN01"
+	constexpr u64 SNAPSHOT_HEADER_SIZE = 4096;
+
+	struct Snapshot {
+		void* data;
+		size_t size;
+
+		void* mapping;      // start of the whole file mapping (including the header)
+		size_t mappingSize;
+
+		void close();
+	};
+
+	// Only works for arenas that haven't chained into a second block, returns false for ones that have
+	bool save_snapshot(Arena& arena, const char* path);
+	// With writable set the mapping is copy-on-write, changes stay in memory and never go back to the file
+	bool load_snapshot(Snapshot& snapshot, const char* path, bool writable = false);
+
+	// Returns a scratch arena that isn't any of the arenas passed in. Use this in functions that
+	// take an arena to return results in, so the temporary allocations don't end up in the caller's memory:
+	//
+	//	Slice<u8> bingus(Arena& out) {
+	//		Arena& scratch = mem::get_scratch(out);
+	//		ArenaScope scope(scratch);
+	//		...
+	//	}
+	template <typename... Conflicts>
+	Arena& get_scratch(Arena& conflict, Conflicts&... rest) {
+		Arena* conflicts[] = { &conflict, &rest... };
+		return get_scratch(conflicts, 1 + sizeof...(rest));
+	}
+
+}
+
+// Data structures built on top of mem
+
+namespace tds {
+	// Growable array that gets its memory from an Arena. While it's the most recent allocation
+	// in the arena it grows in place, otherwise it moves to a spot twice as big and leaves the old one behind.
+	// Elements get moved around with memcpy/memmove, so T has to be trivially copyable
+	template <typename T>
+	struct DynArray {
+		void init(mem::Arena& a, size_t initialCap = 0) {
+			arena = &a;
+			data = nullptr;
+			len = 0;
+			cap = 0;
+			if (initialCap) reserve(initialCap);
+		}
+
+		void reserve(size_t newCap) {
+			if (newCap <= cap) return;
+
+			if (data && arena->try_extend(data, sizeof(T) * cap, sizeof(T) * (newCap - cap))) {
+				cap = newCap;
+				return;
+			}
+
+			T* newData = arena->push_array<T>(newCap);
+			if (len) memcpy(newData, data, sizeof(T) * len);
+			data = newData;
+			cap = newCap;
+		}
+
+		// Gives the unused capacity back to the arena, only possible while the array is at the top
+		void shrink_to_fit() {
+			if (data && arena->is_top(data, sizeof(T) * cap)) {
+				arena->pop(sizeof(T) * (cap - len));
+				cap = len;
+			}
+		}
+
+		T& push(T t) {
+			if (len == cap) reserve(tim::max<size_t>(cap * 2, 8));
+			data[len] = t;
+			return data[len++];
+		}
+
+		T* push_n(const T* src, size_t n) {
+			if (len + n > cap) reserve(tim::max<size_t>(cap * 2, len + n));
+			T* dst = data + len;
+			memcpy(dst, src, sizeof(T) * n);
+			len += n;
+			return dst;
+		}
+
+		T pop() {
+			assert(len > 0);
+			return data[--len];
+		}
+
+		void insert(size_t i, T t) {
+			assert(i <= len);
+			if (len == cap) reserve(tim::max<size_t>(cap * 2, 8));
+			memmove(data + i + 1, data + i, sizeof(T) * (len - i));
+			data[i] = t;
+			len++;
+		}
+
+		// keeps the order of the remaining elements
+		void erase(size_t i) {
+			assert(i < len);
+			memmove(data + i, data + i + 1, sizeof(T) * (len - i - 1));
+			len--;
+		}
+
+		void clear() { len = 0; }
+
+		T& operator[](i64 i) {
+			assert(i >= 0 && i < static_cast<i64>(len));
+			return data[i];
+		}
+
+		Slice<T> slice() { return { data, len }; }
+		operator Slice<T>() { return slice(); }
+
+		T* data;
+		size_t len;
+		size_t cap;
+		mem::Arena* arena;
+	};
+
+	// 64 bit mix (the splitmix64 finalizer), good enough to spread out integer keys
+	constexpr u64 hash_u64(u64 x) {
+		x ^= x >> 30;
+		x *= 0xBF58476D1CE4E5B9ull;
+		x ^= x >> 27;
+		x *= 0x94D049BB133111EBull;
+		return x ^ (x >> 31);
+	}
+
+	// Reads the bytes 8 at a time and mixes each word in
+	inline u64 hash_bytes(const void* ptr, size_t len) {
+		const u8* bytes = static_cast<const u8*>(ptr);
+		u64 h = 0x9E3779B97F4A7C15ull ^ len;
+
+		while (len >= 8) {
+			u64 word;
+			memcpy(&word, bytes, 8);
+			h = hash_u64(h ^ word);
+			bytes += 8;
+			len -= 8;
+		}
+
+		u64 tail = 0;
+		memcpy(&tail, bytes, len);
+		return hash_u64(h ^ tail);
+	}
+
+	// Specialize these two for key types that aren't integers or pointers
+	template <typename K>
+	struct Hash {
+		u64 operator()(const K& key) const { return hash_u64(static_cast<u64>(key)); }
+	};
+
+	template <typename K>
+	struct Hash<K*> {
+		u64 operator()(K* key) const { return hash_u64(reinterpret_cast<uintptr_t>(key)); }
+	};
+
+	template <typename K>
+	struct KeyEqual {
+		bool operator()(const K& a, const K& b) const { return a == b; }
+	};
+
+	// StringSlice keys are hashed and compared by their contents, the characters aren't copied
+	// into the map so they have to stay alive for as long as the key is in it
+	template <>
+	struct Hash<StringSlice> {
+		u64 operator()(const StringSlice& key) const { return hash_bytes(key.data, key.len); }
+	};
+
+	template <>
+	struct KeyEqual<StringSlice> {
+		bool operator()(const StringSlice& a, const StringSlice& b) const {
+			return a.len == b.len && memcmp(a.data, b.data, a.len) == 0;
+		}
+	};
+
+	// Open addressing hash map in the style of abseil's swiss tables. Every slot has a control byte that is
+	// either EMPTY, DELETED, or the low 7 bits of the key's hash, and lookups compare 16 control bytes at once
+	// (with SSE2 when it's there) so most of the time only one key comparison happens.
+	// The tables come out of an Arena. When the map grows the old tables are left behind in it,
+	// so call reserve up front if the final size is known. Keys and values have to be trivially copyable
+	template <typename K, typename V, typename HashFn = Hash<K>, typename EqualFn = KeyEqual<K>>
+	struct HashMap {
+		static constexpr u32 GROUP_SIZE = 16;
+		static constexpr i8 EMPTY = -128;   // 0b10000000
+		static constexpr i8 DELETED = -2;   // 0b11111110
+
+		struct Slot {
+			K key;
+			V value;
+		};
+
+		void init(mem::Arena& a, size_t initialCap = 0) {
+			arena = &a;
+			ctrl = nullptr;
+			slots = nullptr;
+			cap = 0;
+			len = 0;
+			growthLeft = 0;
+			if (initialCap) reserve(initialCap);
+		}
+
+		// Makes sure count keys fit without the map having to grow
+		void reserve(size_t count) {
+			size_t newCap = GROUP_SIZE;
+			while (newCap * 7 / 8 < count) newCap *= 2;
+			if (newCap > cap) rehash(newCap);
+		}
+
+		V* find(const K& key) {
+			if (!cap) return nullptr;
+			i64 idx = find_index(key, HashFn()(key));
+			return idx < 0 ? nullptr : &slots[idx].value;
+		}
+
+		// Returns the value for key, adding it (with an uninitialized value) if it's not in the map yet
+		V* find_or_insert(const K& key, bool* inserted = nullptr) {
+			u64 hash = HashFn()(key);
+			if (cap) {
+				i64 idx = find_index(key, hash);
+				if (idx >= 0) {
+					if (inserted) *inserted = false;
+					return &slots[idx].value;
+				}
+			}
+
+			if (growthLeft == 0) rehash(cap ? (len * 2 >= cap * 7 / 8 ? cap * 2 : cap) : GROUP_SIZE);
+
+			size_t idx = find_free(hash);
+			if (ctrl[idx] == EMPTY) growthLeft--;
+			ctrl[idx] = h2(hash);
+			slots[idx].key = key;
+			len++;
+
+			if (inserted) *inserted = true;
+			return &slots[idx].value;
+		}
+
+		// Adds key or overwrites its value
+		V* insert(const K& key, const V& value) {
+			V* result = find_or_insert(key);
+			*result = value;
+			return result;
+		}
+
+		bool erase(const K& key) {
+			if (!cap) return false;
+			i64 idx = find_index(key, HashFn()(key));
+			if (idx < 0) return false;
+
+			// a lookup that got to this group would have stopped here anyways if it has an empty slot,
+			// so then the slot can go straight back to EMPTY instead of leaving a tombstone
+			size_t group = static_cast<size_t>(idx) & ~static_cast<size_t>(GROUP_SIZE - 1);
+			if (match(group, EMPTY)) {
+				ctrl[idx] = EMPTY;
+				growthLeft++;
+			}
+			else {
+				ctrl[idx] = DELETED;
+			}
+
+			len--;
+			return true;
+		}
+
+		void clear() {
+			if (cap) memset(ctrl, EMPTY, cap);
+			len = 0;
+			growthLeft = cap * 7 / 8;
+		}
+
+		// Calls f(key, value) for everything in the map
+		template <typename F>
+		void for_each(F f) {
+			for (size_t i = 0; i < cap; i++) {
+				if (ctrl[i] >= 0) f(slots[i].key, slots[i].value);
+			}
+		}
+
+		i8* ctrl;
+		Slot* slots;
+		size_t cap;         // always a power of two and a multiple of GROUP_SIZE (or 0)
+		size_t len;
+		size_t growthLeft;  // how many EMPTY slots can still be used before the load factor goes over 7/8
+		mem::Arena* arena;
+
+	private:
+		static i8 h2(u64 hash) { return static_cast<i8>(hash & 0x7F); }
+		static u64 h1(u64 hash) { return hash >> 7; }
+
+		// Bit i is set if the control byte at group + i equals tag
+		u32 match(size_t group, i8 tag) const {
+#ifdef TINYDEF_SSE2
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl + group));
+			return static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(tag))));
+#else
+			u32 mask = 0;
+			for (u32 i = 0; i < GROUP_SIZE; i++) {
+				if (ctrl[group + i] == tag) mask |= 1u << i;
+			}
+			return mask;
+#endif
+		}
+
+		// Bit i is set if the slot is EMPTY or DELETED (those are the only negative control bytes)
+		u32 match_free(size_t group) const {
+#ifdef TINYDEF_SSE2
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl + group));
+			return static_cast<u32>(_mm_movemask_epi8(bytes));
+#else
+			u32 mask = 0;
+			for (u32 i = 0; i < GROUP_SIZE; i++) {
+				if (ctrl[group + i] < 0) mask |= 1u << i;
+			}
+			return mask;
+#endif
+		}
+
+		static u32 lowest_bit(u32 mask) { return tim::log2_floor(mask & (~mask + 1)); }
+
+		// Groups get probed in triangular steps (+1, +2, +3...), which visits every group once
+		// when the group count is a power of two
+		i64 find_index(const K& key, u64 hash) const {
+			size_t groupMask = cap / GROUP_SIZE - 1;
+			size_t group = h1(hash) & groupMask;
+			i8 tag = h2(hash);
+
+			for (size_t step = 1; ; step++) {
+				size_t base = group * GROUP_SIZE;
+				for (u32 hits = match(base, tag); hits; hits &= hits - 1) {
+					size_t idx = base + lowest_bit(hits);
+					if (EqualFn()(slots[idx].key, key)) return static_cast<i64>(idx);
+				}
+
+				if (match(base, EMPTY)) return -1;
+				if (step > groupMask) return -1;
+				group = (group + step) & groupMask;
+			}
+		}
+
+		size_t find_free(u64 hash) const {
+			size_t groupMask = cap / GROUP_SIZE - 1;
+			size_t group = h1(hash) & groupMask;
+
+			for (size_t step = 1; ; step++) {
+				size_t base = group * GROUP_SIZE;
+				u32 freeMask = match_free(base);
+				if (freeMask) return base + lowest_bit(freeMask);
+				group = (group + step) & groupMask;
+			}
+		}
+
+		// Also used to clean out tombstones when growing isn't needed (newCap == cap)
+		void rehash(size_t newCap) {
+			i8* oldCtrl = ctrl;
+			Slot* oldSlots = slots;
+			size_t oldCap = cap;
+
+			ctrl = arena->push_array<i8>(newCap, GROUP_SIZE);
+			slots = arena->push_array<Slot>(newCap);
+			memset(ctrl, EMPTY, newCap);
+			cap = newCap;
+			growthLeft = newCap * 7 / 8 - len;
+
+			for (size_t i = 0; i < oldCap; i++) {
+				if (oldCtrl[i] < 0) continue;
+
+				u64 hash = HashFn()(oldSlots[i].key);
+				size_t idx = find_free(hash);
+				ctrl[idx] = h2(hash);
+				slots[idx] = oldSlots[i];
+			}
+		}
+	};
+
+	// Builds a string by appending straight into an Arena. The characters live in a DynArray,
+	// so while the builder is the most recent allocation in the arena appending never copies
+	// and finish() just hands back the memory that was written to
+	struct StringBuilder {
+		void init(mem::Arena& a, size_t initialCap = 64) {
+			chars.init(a, initialCap);
+		}
+
+		void append_char(char c) {
+			chars.push(c);
+		}
+
+		void append(StringSlice str) {
+			chars.push_n(str.data, str.len);
+		}
+
+		void append(const char* str) {
+			chars.push_n(str, strlen(str));
+		}
+
+		void append_uint(u64 x) {
+			// writes two digits at a time from the back, into a buffer that fits any u64
+			static constexpr char pairs[] =
+				"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+				"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+				"8081828384858687888990919293949596979899";
+			char buf[20];
+			char* end = buf + sizeof(buf);
+			char* p = end;
+
+			while (x >= 100) {
+				u32 pair = static_cast<u32>(x % 100) * 2;
+				x /= 100;
+				*--p = pairs[pair + 1];
+				*--p = pairs[pair];
+			}
+			if (x >= 10) {
+				u32 pair = static_cast<u32>(x) * 2;
+				*--p = pairs[pair + 1];
+				*--p = pairs[pair];
+			}
+			else {
+				*--p = static_cast<char>('0' + x);
+			}
+
+			chars.push_n(p, end - p);
+		}
+
+		void append_int(i64 x) {
+			if (x < 0) {
+				append_char('-');
+				// negating in unsigned so INT64_MIN works
+				append_uint(~static_cast<u64>(x) + 1);
+			}
+			else {
+				append_uint(static_cast<u64>(x));
+			}
+		}
+
+		// Lowercase hex without a prefix, padded with zeroes to at least minDigits
+		void append_hex(u64 x, u32 minDigits = 1) {
+			static constexpr char digits[] = "0123456789abcdef";
+			u32 count = x ? tim::log2_floor(x) / 4 + 1 : 1;
+			count = tim::max(count, tim::min(minDigits, 16u));
+
+			char buf[16];
+			for (u32 i = 0; i < count; i++) {
+				buf[count - 1 - i] = digits[(x >> (i * 4)) & 0xF];
+			}
+			chars.push_n(buf, count);
+		}
+
+		// Shortest representation that reads back as exactly the same number
+		void append_float(f64 x) {
+			char buf[32];
+#if defined(__cpp_lib_to_chars)
+			std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), x);
+			chars.push_n(buf, result.ptr - buf);
+#else
+			int n = 0;
+			for (int precision = 1; precision <= 17; precision++) {
+				n = snprintf(buf, sizeof(buf), "%.*g", precision, x);
+				if (strtod(buf, nullptr) == x) break;
+			}
+			chars.push_n(buf, n);
+#endif
+		}
+
+		// Null terminates the string (the terminator isn't counted in len), gives back any unused capacity
+		// if possible, and returns the string. The builder shouldn't be appended to after this
+		StringSlice finish() {
+			chars.push('\0');
+			chars.shrink_to_fit();
+			chars.len--;
+			return slice();
+		}
+
+		StringSlice slice() {
+			StringSlice result;
+			result.data = chars.data;
+			result.len = chars.len;
+			return result;
+		}
+
+		DynArray<char> chars;
+	};
+
+	// Ring buffer whose memory is mapped twice in a row (see mem::reserve_mirrored), so data[capacity + i]
+	// is the same memory as data[i]. That means any window of up to capacity elements starting inside
+	// the buffer is contiguous: reads and writes that wrap around are a single memcpy, and indexing
+	// from the read position never needs a modulo. Capacity gets rounded up to fill whole mirror_granularity() pages
+	template <typename T>
+	struct MagicRing {
+		bool alloc(size_t minCapacity) {
+			size_t granularity = mem::mirror_granularity();
+			bytes = mem::align_up(minCapacity * sizeof(T), granularity);
+			// the byte size has to hold a whole number of T's for the second copy to line up
+			while (bytes % sizeof(T)) bytes += granularity;
+
+			data = static_cast<T*>(mem::reserve_mirrored(bytes));
+			capacity = bytes / sizeof(T);
+			head = 0;
+			len = 0;
+			return data != nullptr;
+		}
+
+		void dealloc() {
+			mem::release_mirrored(data, bytes);
+			data = nullptr;
+		}
+
+		size_t free_space() const { return capacity - len; }
+
+		// i is relative to the read position, anything below capacity is a valid address
+		T& operator[](size_t i) {
+			assert(i < capacity);
+			return data[head + i];
+		}
+
+		// The next len elements can be read from here without wrapping
+		T* read_ptr() { return data + head; }
+
+		// free_space() elements can be written here, call commit_write once they're filled in
+		T* write_ptr() {
+			size_t tail = head + len;
+			if (tail >= capacity) tail -= capacity;
+			return data + tail;
+		}
+
+		void commit_write(size_t n) {
+			assert(n <= free_space());
+			len += n;
+		}
+
+		void consume(size_t n) {
+			assert(n <= len);
+			head += n;
+			if (head >= capacity) head -= capacity;
+			len -= n;
+		}
+
+		// Writes all n elements or none of them
+		bool push(const T* src, size_t n) {
+			if (n > free_space()) return false;
+			memcpy(write_ptr(), src, sizeof(T) * n);
+			len += n;
+			return true;
+		}
+
+		// Reads up to n elements, returns how many it got
+		size_t pop(T* dst, size_t n) {
+			n = tim::min(n, len);
+			memcpy(dst, read_ptr(), sizeof(T) * n);
+			consume(n);
+			return n;
+		}
+
+		T* data;
+		size_t capacity;  // in elements
+		size_t bytes;     // size of one copy of the mapping
+		size_t head;      // read position, always below capacity
+		size_t len;
+	};
+
+	// Lock free queue for exactly one thread pushing and one thread popping. The buffer is a RING_POW2
+	// RingSlice from an Arena, and head/tail only ever count up, so indexing them is a mask.
+	// Each side keeps a cached copy of the other side's index and only reloads it (with an acquire)
+	// when the queue looks full/empty, so most pushes and pops don't touch the other core's cache line.
+	// Batches go through push_n/pop_n, which pay for one release store per batch instead of one per element.
+	// Elements are copied with memcpy, so T has to be trivially copyable
+	template <typename T>
+	struct SPSCQueue {
+		void init(mem::Arena& a, size_t minCapacity) {
+			size_t cap = 1;
+			while (cap < minCapacity) cap *= 2;
+			ring.data = a.push_array<T>(cap, mem::CACHE_LINE_SIZE);
+			ring.len = cap;
+			head.store(0, std::memory_order_relaxed);
+			tail.store(0, std::memory_order_relaxed);
+			cachedHead = 0;
+			cachedTail = 0;
+		}
+
+		// Producer side
+		bool try_push(const T& value) {
+			size_t t = tail.load(std::memory_order_relaxed);
+			if (t - cachedHead == ring.len) {
+				cachedHead = head.load(std::memory_order_acquire);
+				if (t - cachedHead == ring.len) return false;
+			}
+			ring[static_cast<i64>(t)] = value;
+			tail.store(t + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Pushes as many of the n elements as fit, returns how many that was
+		size_t push_n(const T* src, size_t n) {
+			size_t t = tail.load(std::memory_order_relaxed);
+			size_t space = ring.len - (t - cachedHead);
+			if (space < n) {
+				cachedHead = head.load(std::memory_order_acquire);
+				space = ring.len - (t - cachedHead);
+			}
+			n = tim::min(n, space);
+			if (!n) return 0;
+			ring.write(src, static_cast<i64>(t), n);
+			tail.store(t + n, std::memory_order_release);
+			return n;
+		}
+
+		// Consumer side
+		bool try_pop(T& out) {
+			size_t h = head.load(std::memory_order_relaxed);
+			if (h == cachedTail) {
+				cachedTail = tail.load(std::memory_order_acquire);
+				if (h == cachedTail) return false;
+			}
+			out = ring[static_cast<i64>(h)];
+			head.store(h + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Pops up to n elements, returns how many it got
+		size_t pop_n(T* dst, size_t n) {
+			size_t h = head.load(std::memory_order_relaxed);
+			size_t available = cachedTail - h;
+			if (available < n) {
+				cachedTail = tail.load(std::memory_order_acquire);
+				available = cachedTail - h;
+			}
+			n = tim::min(n, available);
+			if (!n) return 0;
+			ring.read(dst, static_cast<i64>(h), n);
+			head.store(h + n, std::memory_order_release);
+			return n;
+		}
+
+		// Only a snapshot, the other thread can change it right after
+		size_t size() const {
+			return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+		}
+
+		RingSlice<T, RING_POW2> ring;
+
+		// the consumer owns this line, cachedTail is its last look at tail
+		alignas(mem::CACHE_LINE_SIZE) std::atomic<size_t> head;
+		size_t cachedTail;
+
+		// and the producer owns this one
+		alignas(mem::CACHE_LINE_SIZE) std::atomic<size_t> tail;
+		size_t cachedHead;
+	};
+
+	// Bounded lock free queue that any number of threads can push to and pop from (Dmitry Vyukov's design).
+	// Every cell has a sequence number that says whose turn it is: a cell at position p is free for
+	// the producer that claims p when sequence == p, and holds a value for the consumer that claims p when
+	// sequence == p + 1. Claiming a position is a CAS on enqueuePos/dequeuePos, and the cell's sequence
+	// is what hands the value over, so producers and consumers only share cells, not a lock.
+	// The batch calls claim a whole run of ready cells with a single CAS.
+	// Cells come from an Arena and the capacity is rounded up to a power of two.
+	// Values are copied by assignment into uninitialized memory, so T has to be trivially copyable
+	template <typename T>
+	struct MPMCQueue {
+		struct Cell {
+			std::atomic<size_t> sequence;
+			T value;
+		};
+
+		void init(mem::Arena& a, size_t minCapacity) {
+			size_t cap = 2;
+			while (cap < minCapacity) cap *= 2;
+			cells = a.push_array<Cell>(cap, mem::CACHE_LINE_SIZE);
+			mask = cap - 1;
+			for (size_t i = 0; i < cap; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+			enqueuePos.store(0, std::memory_order_relaxed);
+			dequeuePos.store(0, std::memory_order_release);
+		}
+
+		size_t capacity() const { return mask + 1; }
+
+		// Returns false if the queue is full
+		bool try_push(const T& value) {
+			size_t pos = enqueuePos.load(std::memory_order_relaxed);
+			Cell* cell;
+			for (;;) {
+				cell = &cells[pos & mask];
+				size_t seq = cell->sequence.load(std::memory_order_acquire);
+				intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+				if (diff == 0) {
+					if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+				}
+				else if (diff < 0) {
+					return false; // the consumer from one lap ago hasn't taken this cell's value yet
+				}
+				else {
+					pos = enqueuePos.load(std::memory_order_relaxed);
+				}
+			}
+			cell->value = value;
+			cell->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Returns false if the queue is empty
+		bool try_pop(T& out) {
+			size_t pos = dequeuePos.load(std::memory_order_relaxed);
+			Cell* cell;
+			for (;;) {
+				cell = &cells[pos & mask];
+				size_t seq = cell->sequence.load(std::memory_order_acquire);
+				intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+				if (diff == 0) {
+					if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+				}
+				else if (diff < 0) {
+					return false;
+				}
+				else {
+					pos = dequeuePos.load(std::memory_order_relaxed);
+				}
+			}
+			out = cell->value;
+			// frees the cell for the producer one lap ahead
+			cell->sequence.store(pos + mask + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Pushes up to n values, returns how many it got in. The values go in as one contiguous run,
+		// so they come out in order relative to each other (other producers can't interleave)
+		size_t try_push_n(const T* src, size_t n) {
+			n = tim::min(n, capacity());
+			size_t pos = enqueuePos.load(std::memory_order_relaxed);
+			size_t ready;
+			for (;;) {
+				ready = count_ready(pos, 0, n);
+				if (!ready) {
+					// either the queue is full or pos is stale, only the second one is worth another try
+					size_t current = enqueuePos.load(std::memory_order_relaxed);
+					if (current == pos) return 0;
+					pos = current;
+					continue;
+				}
+				if (enqueuePos.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) break;
+			}
+			for (size_t i = 0; i < ready; i++) {
+				Cell& cell = cells[(pos + i) & mask];
+				cell.value = src[i];
+				cell.sequence.store(pos + i + 1, std::memory_order_release);
+			}
+			return ready;
+		}
+
+		// Pops up to n values, returns how many it got
+		size_t try_pop_n(T* dst, size_t n) {
+			n = tim::min(n, capacity());
+			size_t pos = dequeuePos.load(std::memory_order_relaxed);
+			size_t ready;
+			for (;;) {
+				ready = count_ready(pos, 1, n);
+				if (!ready) {
+					size_t current = dequeuePos.load(std::memory_order_relaxed);
+					if (current == pos) return 0;
+					pos = current;
+					continue;
+				}
+				if (dequeuePos.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) break;
+			}
+			for (size_t i = 0; i < ready; i++) {
+				Cell& cell = cells[(pos + i) & mask];
+				dst[i] = cell.value;
+				cell.sequence.store(pos + i + mask + 1, std::memory_order_release);
+			}
+			return ready;
+		}
+
+		// The blocking versions spin for a bit and then start yielding until they get through
+		void push(const T& value) {
+			for (u32 spins = 0; !try_push(value); spins++) backoff(spins);
+		}
+
+		T pop() {
+			T result;
+			for (u32 spins = 0; !try_pop(result); spins++) backoff(spins);
+			return result;
+		}
+
+		void push_n(const T* src, size_t n) {
+			u32 spins = 0;
+			while (n) {
+				size_t pushed = try_push_n(src, n);
+				src += pushed;
+				n -= pushed;
+				if (pushed) spins = 0;
+				else backoff(spins++);
+			}
+		}
+
+		// Waits until at least one value is there, then pops up to n
+		size_t pop_n(T* dst, size_t n) {
+			size_t popped;
+			for (u32 spins = 0; !(popped = try_pop_n(dst, n)); spins++) backoff(spins);
+			return popped;
+		}
+
+		// Only a snapshot, other threads can change it right after
+		size_t size() const {
+			size_t head = dequeuePos.load(std::memory_order_acquire);
+			size_t tail = enqueuePos.load(std::memory_order_acquire);
+			return tail > head ? tail - head : 0;
+		}
+
+		// How many cells starting at pos are ready in a row, for a producer (lap = 0) or a consumer (lap = 1)
+		size_t count_ready(size_t pos, size_t lap, size_t n) {
+			size_t ready = 0;
+			while (ready < n && cells[(pos + ready) & mask].sequence.load(std::memory_order_acquire) == pos + ready + lap) {
+				ready++;
+			}
+			return ready;
+		}
+
+		static void backoff(u32 spins) {
+			if (spins < 64) {
+#if defined(TINYDEF_SSE2)
+				_mm_pause();
+#endif
+			}
+			else {
+				mem::yield_thread();
+			}
+		}
+
+		Cell* cells;
+		size_t mask;
+
+		// producers and consumers each hammer their own position, so they get separate cache lines
+		alignas(mem::CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos;
+		alignas(mem::CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos;
+	};
+}
+
+
+#ifdef TINYDEF_IMPLEMENTATION
+
+#include <assert.h>
+
+#if defined(USING_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(USING_UNIX)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#if !defined(__linux__)
+#include <stdlib.h> // mkstemp
+#endif
+#else
+#error Memory abstractions not implemented for this platform!
+#endif
+
+#ifdef TINYDEF_ARENA_STATS
+#include <stdio.h>
+#include <mutex>
+#endif
+
+//
+// MEMORY ABSTRACTION IMPLEMENTATION
+//
+
+namespace mem {
+
+	// 4096 is a common page size, but for it to actually be accurate,
+	// we need to set this using information obtained from the OS in mem::init()
+	u64 pageSize = 4096;
+	u64 round_to_page_size(u64 size) {
+		u64 rem = size % pageSize;
+		size -= rem;
+		return size + pageSize;
+	}
+
+#if defined(USING_WIN32)
+	inline u64 get_page_size() {
+		SYSTEM_INFO si = { 0 };
+		GetSystemInfo(&si);
+		return si.dwPageSize;
+	}
+
+	inline void* _reserve(size_t cap) {
+		// maybe round_to_page_size should be used here?
+		return VirtualAlloc(nullptr, cap, MEM_RESERVE, PAGE_READWRITE);
+	}
+
+	inline void* _commit(void* start, size_t size) {
+		return VirtualAlloc(start, size, MEM_COMMIT, PAGE_READWRITE);
+	}
+
+	// Windows can't give back part of a reservation, so we look for a spot that's big enough,
+	// free it, and then try to reserve the aligned address inside of it (someone else might get there first)
+	inline void* _reserve_aligned(size_t cap, size_t align) {
+		for (int attempt = 0; attempt < 8; attempt++) {
+			void* probe = VirtualAlloc(nullptr, cap + align, MEM_RESERVE, PAGE_NOACCESS);
+			if (!probe) return nullptr;
+			VirtualFree(probe, 0, MEM_RELEASE);
+
+			void* aligned = reinterpret_cast<void*>(align_up(reinterpret_cast<uintptr_t>(probe), align));
+			void* result = VirtualAlloc(aligned, cap, MEM_RESERVE, PAGE_READWRITE);
+			if (result) return result;
+		}
+
+		return nullptr;
+	}
+
+	// Large pages on windows need SeLockMemoryPrivilege and have to be committed up front,
+	// which defeats the point of reserving, so we only get the alignment and the bigger commits
+	inline bool _advise_huge_pages(void* region, size_t size) {
+		return false;
+	}
+
+	inline bool _release(void* region, size_t size) {
+		return VirtualFree(region, 0, MEM_RELEASE);
+	}
+
+#pragma warning(disable : 6250)
+	inline bool _decommit(void* region, size_t size) {
+		return VirtualFree(region, size, MEM_DECOMMIT);
+	}
+
+	// Touching a page is the only way to fault it in here, the write keeps whatever was in it
+	inline void _populate(void* start, size_t size) {
+		volatile u8* bytes = static_cast<volatile u8*>(start);
+		for (size_t offset = 0; offset < size; offset += pageSize) bytes[offset] = bytes[offset];
+	}
+
+	// MEM_RESET would keep the commit charge, so there's nothing lazier than a decommit that fits here
+	inline bool _decommit_lazy(void* region, size_t size) {
+		return _decommit(region, size);
+	}
+
+	inline bool _write_file(const char* path, const void* header, size_t headerSize, const void* body, size_t bodySize) {
+		HANDLE file = CreateFileA(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		bool ok = true;
+		const void* parts[2] = { header, body };
+		size_t sizes[2] = { headerSize, bodySize };
+		for (int i = 0; i < 2 && ok; i++) {
+			const u8* bytes = static_cast<const u8*>(parts[i]);
+			size_t left = sizes[i];
+			while (left && ok) {
+				DWORD written = 0;
+				DWORD chunk = static_cast<DWORD>(tim::min<size_t>(left, 1u << 30));
+				ok = WriteFile(file, bytes, chunk, &written, nullptr) && written;
+				bytes += written;
+				left -= written;
+			}
+		}
+
+		CloseHandle(file);
+		return ok;
+	}
+
+	// The view keeps the file mapping alive, so both handles can be closed right away
+	inline void* _map_file(const char* path, bool writable, size_t* outSize) {
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+		LARGE_INTEGER fileSize;
+		void* view = nullptr;
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+			HANDLE mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+			if (mapping) {
+				view = MapViewOfFile(mapping, writable ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);
+			}
+			*outSize = static_cast<size_t>(fileSize.QuadPart);
+		}
+
+		CloseHandle(file);
+		return view;
+	}
+
+	inline bool _unmap_file(void* base, size_t size) {
+		return UnmapViewOfFile(base);
+	}
+
+	// File backed arenas aren't supported on windows yet: a file mapping can't be bigger than the file
+	// without the file growing to that size right away, so there's no cheap way to reserve ahead of it
+	inline intptr_t _open_file(const char* path, size_t* outSize) {
+		return -1;
+	}
+
+	inline void* _map_file_shared(intptr_t file, size_t cap) {
+		return nullptr;
+	}
+
+	inline bool _resize_file(intptr_t file, size_t size) {
+		return false;
+	}
+
+	inline void _close_file(intptr_t file) {}
+
+	// There's no way to reserve a range and then map into it on older windows versions (VirtualAlloc2 needs 10),
+	// so we find a free spot, let go of it and try to map both views there before someone else takes it
+	inline void* _reserve_mirrored(size_t size) {
+		HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+			static_cast<DWORD>(static_cast<u64>(size) >> 32), static_cast<DWORD>(size), nullptr);
+		if (!mapping) return nullptr;
+
+		void* result = nullptr;
+		for (int attempt = 0; attempt < 8 && !result; attempt++) {
+			u8* probe = static_cast<u8*>(VirtualAlloc(nullptr, size * 2, MEM_RESERVE, PAGE_NOACCESS));
+			if (!probe) break;
+			VirtualFree(probe, 0, MEM_RELEASE);
+
+			void* first = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size, probe);
+			void* second = first ? MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size, probe + size) : nullptr;
+			if (first && second) {
+				result = first;
+			}
+			else if (first) {
+				UnmapViewOfFile(first);
+			}
+		}
+
+		// the views keep the mapping alive
+		CloseHandle(mapping);
+		return result;
+	}
+
+	inline void _release_mirrored(void* base, size_t size) {
+		UnmapViewOfFile(static_cast<u8*>(base) + size);
+		UnmapViewOfFile(base);
+	}
+
+	inline size_t _mirror_granularity() {
+		SYSTEM_INFO si = { 0 };
+		GetSystemInfo(&si);
+		return si.dwAllocationGranularity;
+	}
+
+	inline void _yield() {
+		SwitchToThread();
+	}
+
+	// Windows can only pick a node when memory is reserved/committed (VirtualAllocExNuma),
+	// so binding a range after the fact isn't possible and NUMA placement is left to the OS
+	inline u32 _numa_node_count() {
+		return 1;
+	}
+
+	inline i32 _current_numa_node() {
+		return 0;
+	}
+
+	inline bool _bind_numa(void* region, size_t size, i32 node) {
+		return false;
+	}
+
+#elif defined(USING_UNIX)
+	inline u64 get_page_size() {
+		return static_cast<u64>(sysconf(_SC_PAGESIZE));
+	}
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+	// Reserving maps the range with no access rights, so it takes up address space but no memory
+	inline void* _reserve(size_t cap) {
+		void* result = mmap(nullptr, cap, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		return result == MAP_FAILED ? nullptr : result;
+	}
+
+	// Over-reserves by align and unmaps whatever sticks out on either side
+	inline void* _reserve_aligned(size_t cap, size_t align) {
+		u8* raw = static_cast<u8*>(_reserve(cap + align));
+		if (!raw) return nullptr;
+
+		u8* aligned = reinterpret_cast<u8*>(align_up(reinterpret_cast<uintptr_t>(raw), align));
+		if (aligned != raw) munmap(raw, aligned - raw);
+		munmap(aligned + cap, (raw + cap + align) - (aligned + cap));
+		return aligned;
+	}
+
+	// MAP_HUGETLB is not used since it needs pages set aside by the admin, and with MAP_NORESERVE
+	// running out of them means a SIGBUS on first touch instead of an error we could handle
+	inline bool _advise_huge_pages(void* region, size_t size) {
+#ifdef MADV_HUGEPAGE
+		return madvise(region, size, MADV_HUGEPAGE) == 0;
+#else
+		return false;
+#endif
+	}
+
+	// Unlike VirtualAlloc, mprotect won't round the range to pages for us
+	inline void* _commit(void* start, size_t size) {
+		uintptr_t first = align_down(reinterpret_cast<uintptr_t>(start), pageSize);
+		uintptr_t last = align_up(reinterpret_cast<uintptr_t>(start) + size, pageSize);
+		if (mprotect(reinterpret_cast<void*>(first), last - first, PROT_READ | PROT_WRITE) != 0) return nullptr;
+		return start;
+	}
+
+	inline bool _release(void* region, size_t size) {
+		return munmap(region, size) == 0;
+	}
+
+	// MADV_DONTNEED hands the pages back to the OS, and dropping the access rights
+	// makes touching decommitted memory fault the same way it does on windows
+	inline bool _decommit(void* region, size_t size) {
+		uintptr_t first = align_up(reinterpret_cast<uintptr_t>(region), pageSize);
+		uintptr_t last = align_down(reinterpret_cast<uintptr_t>(region) + size, pageSize);
+		if (last <= first) return true;
+
+		void* start = reinterpret_cast<void*>(first);
+		if (madvise(start, last - first, MADV_DONTNEED) != 0) return false;
+		return mprotect(start, last - first, PROT_NONE) == 0;
+	}
+
+#if defined(__linux__) && !defined(MADV_POPULATE_WRITE)
+#define MADV_POPULATE_WRITE 23
+#endif
+
+	// MADV_POPULATE_WRITE (linux 5.14) faults the whole range in with one call, older kernels
+	// (and other unixes) get every page touched instead, the write keeps whatever was in it.
+	// MAP_POPULATE doesn't help since the reservation is PROT_NONE when it gets mapped
+	inline void _populate(void* start, size_t size) {
+		uintptr_t first = align_down(reinterpret_cast<uintptr_t>(start), pageSize);
+		uintptr_t last = align_up(reinterpret_cast<uintptr_t>(start) + size, pageSize);
+#ifdef MADV_POPULATE_WRITE
+		if (madvise(reinterpret_cast<void*>(first), last - first, MADV_POPULATE_WRITE) == 0) return;
+#endif
+		for (uintptr_t page = first; page < last; page += pageSize) {
+			volatile u8* byte = reinterpret_cast<volatile u8*>(page);
+			*byte = *byte;
+		}
+	}
+
+	// MADV_FREE leaves the pages where they are until there's memory pressure,
+	// which makes decommitting and then committing the same range again cheap
+	inline bool _decommit_lazy(void* region, size_t size) {
+#ifdef MADV_FREE
+		uintptr_t first = align_up(reinterpret_cast<uintptr_t>(region), pageSize);
+		uintptr_t last = align_down(reinterpret_cast<uintptr_t>(region) + size, pageSize);
+		if (last <= first) return true;
+
+		void* start = reinterpret_cast<void*>(first);
+		if (madvise(start, last - first, MADV_FREE) != 0) return _decommit(region, size);
+		return mprotect(start, last - first, PROT_NONE) == 0;
+#else
+		return _decommit(region, size);
+#endif
+	}
+
+	inline bool _write_file(const char* path, const void* header, size_t headerSize, const void* body, size_t bodySize) {
+		int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0) return false;
+
+		bool ok = true;
+		const void* parts[2] = { header, body };
+		size_t sizes[2] = { headerSize, bodySize };
+		for (int i = 0; i < 2 && ok; i++) {
+			const u8* bytes = static_cast<const u8*>(parts[i]);
+			size_t left = sizes[i];
+			while (left && ok) {
+				ssize_t written = write(fd, bytes, left);
+				ok = written > 0;
+				if (ok) {
+					bytes += written;
+					left -= written;
+				}
+			}
+		}
+
+		return ::close(fd) == 0 && ok;
+	}
+
+	// MAP_PRIVATE makes a writable mapping copy-on-write, the file itself is never changed.
+	// The mapping keeps the file alive, so the descriptor can be closed right away
+	inline void* _map_file(const char* path, bool writable, size_t* outSize) {
+		int fd = open(path, O_RDONLY);
+		if (fd < 0) return nullptr;
+
+		void* result = nullptr;
+		struct stat st;
+		if (fstat(fd, &st) == 0 && st.st_size > 0) {
+			int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+			result = mmap(nullptr, st.st_size, prot, MAP_PRIVATE, fd, 0);
+			if (result == MAP_FAILED) result = nullptr;
+			*outSize = static_cast<size_t>(st.st_size);
+		}
+
+		::close(fd);
+		return result;
+	}
+
+	inline bool _unmap_file(void* base, size_t size) {
+		return munmap(base, size) == 0;
+	}
+
+	inline intptr_t _open_file(const char* path, size_t* outSize) {
+		int fd = open(path, O_RDWR | O_CREAT, 0644);
+		if (fd < 0) return -1;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0) {
+			::close(fd);
+			return -1;
+		}
+
+		*outSize = static_cast<size_t>(st.st_size);
+		return fd;
+	}
+
+	// The whole range gets mapped up front, which is fine since only the part
+	// that's inside the file can be touched (past the end of the file is a SIGBUS)
+	inline void* _map_file_shared(intptr_t file, size_t cap) {
+		void* result = mmap(nullptr, cap, PROT_READ | PROT_WRITE, MAP_SHARED, static_cast<int>(file), 0);
+		return result == MAP_FAILED ? nullptr : result;
+	}
+
+	inline bool _resize_file(intptr_t file, size_t size) {
+		return ftruncate(static_cast<int>(file), static_cast<off_t>(size)) == 0;
+	}
+
+	inline void _close_file(intptr_t file) {
+		::close(static_cast<int>(file));
+	}
+
+	// The memory comes from an anonymous file (memfd on linux, an unlinked temp file elsewhere),
+	// which gets mapped twice over a reservation so nothing else can end up in between the two copies
+	inline void* _reserve_mirrored(size_t size) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+		int fd = static_cast<int>(syscall(SYS_memfd_create, "tinydef-ring", 0));
+#else
+		char path[] = "/tmp/tinydef-ring-XXXXXX";
+		int fd = mkstemp(path);
+		if (fd >= 0) unlink(path);
+#endif
+		if (fd < 0) return nullptr;
+
+		u8* base = nullptr;
+		if (ftruncate(fd, static_cast<off_t>(size)) == 0) base = static_cast<u8*>(_reserve(size * 2));
+
+		if (base) {
+			void* first = mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+			void* second = mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+			if (first == MAP_FAILED || second == MAP_FAILED) {
+				munmap(base, size * 2);
+				base = nullptr;
+			}
+		}
+
+		// the mappings keep the file alive
+		::close(fd);
+		return base;
+	}
+
+	inline void _release_mirrored(void* base, size_t size) {
+		munmap(base, size * 2);
+	}
+
+	inline size_t _mirror_granularity() {
+		return pageSize;
+	}
+
+	inline void _yield() {
+		sched_yield();
+	}
+
+	// The NUMA calls go through syscall() directly so there's no dependency on libnuma.
+	// Anything that fails (no NUMA support in the kernel, not linux, seccomp...) counts as a single node
+	constexpr u32 MAX_NUMA_NODES = 1024;
+
+	inline u32 _numa_node_count() {
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+		unsigned long mask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = {};
+		const unsigned long MPOL_F_MEMS_ALLOWED = 1 << 2;
+		if (syscall(SYS_get_mempolicy, nullptr, mask, MAX_NUMA_NODES + 1, nullptr, MPOL_F_MEMS_ALLOWED) != 0) return 1;
+
+		u32 count = 0;
+		for (unsigned long word : mask) count += static_cast<u32>(__builtin_popcountl(word));
+		return count ? count : 1;
+#else
+		return 1;
+#endif
+	}
+
+	inline i32 _current_numa_node() {
+#if defined(__linux__) && defined(SYS_getcpu)
+		unsigned cpu = 0, node = 0;
+		if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) return 0;
+		return static_cast<i32>(node);
+#else
+		return 0;
+#endif
+	}
+
+	// MPOL_PREFERRED instead of MPOL_BIND, so a full node spills over to another one instead of failing
+	inline bool _bind_numa(void* region, size_t size, i32 node) {
+#if defined(__linux__) && defined(SYS_mbind)
+		if (node < 0 || node >= static_cast<i32>(MAX_NUMA_NODES)) return false;
+
+		unsigned long mask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = {};
+		const u32 bitsPerWord = 8 * sizeof(unsigned long);
+		mask[node / bitsPerWord] = 1ul << (node % bitsPerWord);
+
+		const int MPOL_PREFERRED = 1;
+		return syscall(SYS_mbind, region, size, MPOL_PREFERRED, mask, MAX_NUMA_NODES + 1, 0) == 0;
+#else
+		return false;
+#endif
+	}
+
+#endif
+
+	//
+	// MEMORY STRUCTURES IMPLEMENTATION
+	// NOTE: Platform specific code is above
+	//
+
+	// Scratch arenas are per thread, so they can be used without any locking.
+	// The destructor gives a thread's arenas back when the thread exits
+	struct ScratchArenas {
+		Arena arenas[SCRATCH_COUNT] = {};
+
+		~ScratchArenas() {
+			for (Arena& arena : arenas) {
+				if (arena.data) arena.dealloc();
+			}
+		}
+	};
+
+	thread_local ScratchArenas scratchArenas;
+
+	u32 numaNodeCount = 1;
+
+	void init() {
+		pageSize = get_page_size();
+		numaNodeCount = _numa_node_count();
+		get_scratch();
+	}
+
+	u32 numa_node_count() {
+		return numaNodeCount;
+	}
+
+	i32 current_numa_node() {
+		return numaNodeCount > 1 ? _current_numa_node() : 0;
+	}
+
+	void* reserve_mirrored(size_t size) {
+		assert(size % _mirror_granularity() == 0);
+		return _reserve_mirrored(size);
+	}
+
+	void release_mirrored(void* base, size_t size) {
+		_release_mirrored(base, size);
+	}
+
+	size_t mirror_granularity() {
+		return _mirror_granularity();
+	}
+
+	void yield_thread() {
+		_yield();
+	}
+
+	// Only releases the scratch arenas of the calling thread, other threads release theirs when they exit
+	void close() {
+		for (Arena& arena : scratchArenas.arenas) {
+			if (arena.data) arena.dealloc();
+		}
+	}
+
+	Arena& get_scratch() {
+		// we're not clearing here anymore since anyone that calls this function
+		// might not specifically want to clear the arena unnecessarily
+		return get_scratch(nullptr, 0);
+	}
+
+	Arena& get_scratch(Arena* const* conflicts, u32 count) {
+		for (Arena& arena : scratchArenas.arenas) {
+			bool conflicting = false;
+			for (u32 i = 0; i < count; i++) {
+				if (conflicts[i] == &arena) conflicting = true;
+			}
+			if (conflicting) continue;
+
+			// threads are usually pinned by the time they do real work, so putting scratch memory
+			// on the node of whoever touches it first is almost always right
+			if (!arena.data) {
+				arena.alloc(100000000LL, ARENA_NUMA_LOCAL);
+#ifdef TINYDEF_ARENA_STATS
+				arena.stats.name = "scratch";
+#endif
+			}
+			return arena;
+		}
+
+		// every scratch arena was passed in as a conflict, SCRATCH_COUNT needs to be raised
+		assert(false);
+		return scratchArenas.arenas[0];
+	}
+
+#ifdef TINYDEF_ARENA_STATS
+	Arena* liveArenas = nullptr;
+	std::mutex liveArenasLock;
+
+	void stats_register(Arena& arena) {
+		memset(&arena.stats, 0, sizeof(arena.stats));
+		arena.stats.name = "arena";
+
+		std::lock_guard<std::mutex> guard(liveArenasLock);
+		arena.stats.nextLive = liveArenas;
+		if (liveArenas) liveArenas->stats.prevLive = &arena;
+		liveArenas = &arena;
+	}
+
+	void stats_unregister(Arena& arena) {
+		std::lock_guard<std::mutex> guard(liveArenasLock);
+		if (arena.stats.prevLive) arena.stats.prevLive->stats.nextLive = arena.stats.nextLive;
+		else liveArenas = arena.stats.nextLive;
+		if (arena.stats.nextLive) arena.stats.nextLive->stats.prevLive = arena.stats.prevLive;
+	}
+
+	void stats_push(Arena& arena, size_t len) {
+		u32 bucket = 0;
+		while ((len >> bucket) > 1) bucket++;
+
+		arena.stats.pushCount++;
+		arena.stats.sizeHistogram[bucket]++;
+		arena.stats.peakPos = tim::max(arena.stats.peakPos, arena.pos);
+	}
+
+	void dump_arena_stats() {
+		std::lock_guard<std::mutex> guard(liveArenasLock);
+		for (Arena* arena = liveArenas; arena; arena = arena->stats.nextLive) {
+			const ArenaStats& stats = arena->stats;
+			printf("%s (%p): pos %zu, peak %zu, committed %zu, %llu commits, %llu decommits, %llu pushes\n",
+				stats.name, static_cast<void*>(arena), arena->pos, stats.peakPos, stats.committedBytes,
+				(unsigned long long)stats.commitCalls, (unsigned long long)stats.decommitCalls,
+				(unsigned long long)stats.pushCount);
+
+			for (u32 i = 0; i < 64; i++) {
+				if (stats.sizeHistogram[i] == 0) continue;
+				printf("    [%llu, %llu): %llu\n", i ? 1ull << i : 0ull, 2ull << i, (unsigned long long)stats.sizeHistogram[i]);
+			}
+		}
+	}
+#endif
+
+	// Every chained block starts with one of these, holding the state of the block before it
+	// and the pos the chained block itself starts at (the pos it was chained from)
+	struct ArenaBlock {
+		ArenaBlock* prev;
+		void* data;
+		size_t capacity;
+		size_t committed;
+		size_t basePos;
+		size_t startPos;
+	};
+
+	constexpr size_t ARENA_BLOCK_HEADER = align_up(sizeof(ArenaBlock), 16);
+
+	// First page of the file behind a file backed arena. length is kept equal to pos on every push and pop,
+	// so after a crash the arena reopens with what was pushed instead of the padding the file grew by
+	struct FileArenaHeader {
+		u64 magic;
+		u64 length;
+	};
+
+	constexpr u64 FILE_ARENA_MAGIC = 0x31304E5241544454ull; // "TDTARN01"
+	constexpr u64 FILE_ARENA_HEADER_SIZE = 4096;
+
+	// Rounds cap up to what the block will actually hold and reserves it
+	void* reserve_arena_block(u64& cap, u32 flags, i32 numaNode = -1) {
+		void* block;
+		if (flags & ARENA_HUGE_PAGES) {
+			// the huge page size has to line up with both ends of the range or the OS won't use huge pages for it
+			cap = align_up(cap, HUGE_PAGE_SIZE);
+			block = mem::_reserve_aligned(cap, HUGE_PAGE_SIZE);
+			if (block) mem::_advise_huge_pages(block, cap);
+		}
+		else {
+			cap = round_to_page_size(cap);
+			block = mem::_reserve(cap);
+		}
+
+		assert(block);
+		if (numaNode >= 0 && numaNodeCount > 1) mem::_bind_numa(block, cap, numaNode);
+		return block;
+	}
+
+	void Arena::alloc(u64 cap, u32 arenaFlags) {
+		// we want to reserve a good spot between "too little" and "holy balls that's too much" memory
+		// when this turns out to be too little memory, either raise this size or use ARENA_CHAINED
+		flags = arenaFlags & ~ARENA_FILE_BACKED;
+		file = -1;
+		numaNode = (flags & ARENA_NUMA_LOCAL) ? current_numa_node() : -1;
+		pos = 0;
+		basePos = 0;
+		committed = 0;
+		prevBlock = nullptr;
+		commitChunk = (flags & ARENA_HUGE_PAGES) ? HUGE_PAGE_SIZE : align_up(ARENA_COMMIT_CHUNK, pageSize);
+		set_decommit_policy(0, 0);
+
+		data = reserve_arena_block(cap, flags, numaNode);
+		capacity = cap;
+
+#ifdef TINYDEF_ARENA_STATS
+		stats_register(*this);
+#endif
+
+		// We'll commit the first chunk of memory, so that we can initially make use of it
+		commit_to(1);
+	}
+
+	// Moves the arena onto a fresh block that can fit at least len bytes.
+	// Whatever was left at the end of the old block goes unused until we pop back into it
+	void Arena::chain(size_t len) {
+		assert(!(flags & ARENA_FILE_BACKED));
+		ArenaBlock old = { prevBlock, data, capacity, committed, basePos, pos };
+
+		u64 cap = tim::max<u64>(capacity * 2, ARENA_BLOCK_HEADER + len + 1);
+		data = reserve_arena_block(cap, flags, numaNode);
+		capacity = cap;
+		committed = 0;
+
+		// the header takes up the start of the block, so the first usable byte lines up with the current pos.
+		// basePos wraps around when pos is below the header size, which is fine since it's only ever subtracted
+		basePos = pos - ARENA_BLOCK_HEADER;
+		commit_to(pos);
+
+		prevBlock = static_cast<ArenaBlock*>(data);
+		*prevBlock = old;
+	}
+
+	void ConcurrentArena::alloc(u64 cap, u32 arenaFlags) {
+		assert(!(arenaFlags & ARENA_CHAINED));
+		flags = arenaFlags;
+		commitChunk = (flags & ARENA_HUGE_PAGES) ? HUGE_PAGE_SIZE : align_up(ARENA_COMMIT_CHUNK, pageSize);
+		data = reserve_arena_block(cap, flags);
+		capacity = cap;
+
+		pos.store(0, std::memory_order_relaxed);
+		committed.store(0, std::memory_order_relaxed);
+		committing.store(false, std::memory_order_relaxed);
+		commit_to(1);
+	}
+
+	void ConcurrentArena::dealloc() {
+		mem::_release(data, capacity);
+		capacity = 0;
+		data = nullptr;
+	}
+
+	// Not safe to call while other threads are still pushing
+	void ConcurrentArena::clear() {
+		pos.store(0, std::memory_order_relaxed);
+	}
+
+	// Only one thread at a time gets to commit, and everyone else spins until the range they need shows up.
+	// Commits are rare (once per commitChunk bytes) so waiting on them is cheaper than anything smarter
+	bool ConcurrentArena::commit_to(size_t end) {
+		if (end > capacity) return false;
+		while (committed.load(std::memory_order_acquire) < end) {
+			if (committing.exchange(true, std::memory_order_acquire)) {
+				while (committing.load(std::memory_order_relaxed)) {}
+				continue;
+			}
+
+			bool ok = true;
+			size_t have = committed.load(std::memory_order_relaxed);
+			if (have < end) {
+				size_t newCommitted = tim::min<size_t>(align_up(end, commitChunk), capacity);
+				ok = _commit(static_cast<u8*>(data) + have, newCommitted - have) != nullptr;
+				if (ok) committed.store(newCommitted, std::memory_order_release);
+			}
+
+			committing.store(false, std::memory_order_release);
+			if (!ok) return false;
+		}
+
+		return true;
+	}
+
+	// Returns nullptr once the arena is out of space (or the OS won't commit more),
+	// pos stays past the end after that so every later push fails too
+	void* ConcurrentArena::push(size_t len) {
+		size_t offset = pos.fetch_add(len, std::memory_order_relaxed);
+		if (offset + len > committed.load(std::memory_order_acquire)) {
+			if (!commit_to(offset + len)) return nullptr;
+		}
+		return static_cast<u8*>(data) + offset;
+	}
+
+	// The padding depends on where pos is when the space gets claimed (someone else might move it first),
+	// so instead of a fetch_add this works out the exact padding and claims it with a CAS, retrying if pos moved
+	void* ConcurrentArena::push_aligned(size_t len, size_t align) {
+		assert(align && (align & (align - 1)) == 0);
+		if (align == 1) return push(len);
+
+		uintptr_t base = reinterpret_cast<uintptr_t>(data);
+		size_t offset = pos.load(std::memory_order_relaxed);
+		size_t start;
+		do {
+			start = align_up(base + offset, align) - base;
+		} while (!pos.compare_exchange_weak(offset, start + len, std::memory_order_relaxed));
+
+		if (start + len > committed.load(std::memory_order_acquire)) {
+			if (!commit_to(start + len)) return nullptr;
+		}
+		return static_cast<u8*>(data) + start;
+	}
+
+	void* ConcurrentArena::push_zero(size_t len) {
+		void* result = push(len);
+		return result ? memset(result, 0, len) : nullptr;
+	}
+
+	// Maps the file at path as the arena's memory. Pushing grows the file in commitChunk steps,
+	// and whatever was pushed before counts as pushed again, so a log can be reopened and appended to.
+	// The file has a FileArenaHeader in front of the data, a file that isn't empty and doesn't have one
+	// (or claims more data than it holds) is refused. dealloc trims the file back down to pos
+	bool Arena::alloc_file(const char* path, u64 cap) {
+		size_t existing = 0;
+		intptr_t handle = _open_file(path, &existing);
+		if (handle < 0) return false;
+
+		u64 fullCap = round_to_page_size(tim::max<u64>(cap + FILE_ARENA_HEADER_SIZE, existing));
+		void* mapping = _map_file_shared(handle, fullCap);
+		if (!mapping) {
+			_close_file(handle);
+			return false;
+		}
+
+		FileArenaHeader info = { FILE_ARENA_MAGIC, 0 };
+		if (existing) {
+			if (existing >= FILE_ARENA_HEADER_SIZE) memcpy(&info, mapping, sizeof(info));
+			if (existing < FILE_ARENA_HEADER_SIZE || info.magic != FILE_ARENA_MAGIC || info.length > existing - FILE_ARENA_HEADER_SIZE) {
+				_unmap_file(mapping, fullCap);
+				_close_file(handle);
+				return false;
+			}
+		}
+
+		flags = ARENA_FILE_BACKED;
+		file = handle;
+		numaNode = -1;
+		data = mapping;
+		capacity = fullCap;
+		pos = info.length;
+		// same trick as a chained block, the header sits at data[0] and pos 0 starts right after it
+		basePos = 0 - FILE_ARENA_HEADER_SIZE;
+		committed = existing;
+		prevBlock = nullptr;
+		commitChunk = align_up(ARENA_COMMIT_CHUNK, pageSize);
+		set_decommit_policy(0, 0);
+
+#ifdef TINYDEF_ARENA_STATS
+		stats_register(*this);
+		stats.committedBytes = existing;
+		stats.peakPos = pos;
+		// not the path, the caller's string might not outlive the arena (set a name after alloc_file instead)
+		stats.name = "file arena";
+#endif
+
+		// makes sure the header page is in the file before writing to it
+		if (!commit_to(pos + 1)) {
+			dealloc();
+			return false;
+		}
+		memcpy(data, &info, sizeof(info));
+		return true;
+	}
+
+	// Asks for the arena's memory (including blocks it chains into later) to be placed on node.
+	// Only pages that haven't been touched yet move, so this is best done right after alloc.
+	// On a machine with a single node this does nothing
+	bool Arena::bind_numa(i32 node) {
+		numaNode = node;
+		if (numaNodeCount <= 1 || (flags & ARENA_FILE_BACKED)) return false;
+		return _bind_numa(data, capacity, node);
+	}
+
+	void Arena::dealloc() {
+		if (flags & ARENA_FILE_BACKED) {
+			// gets rid of the padding from committing in chunks, so the file ends where the data does
+			_resize_file(file, pos - basePos);
+			_unmap_file(data, capacity);
+			_close_file(file);
+
+#ifdef TINYDEF_ARENA_STATS
+			stats_unregister(*this);
+#endif
+
+			capacity = 0;
+			data = nullptr;
+			return;
+		}
+
+		// added this, not sure if it's really required
+		clear_decommit();
+		// we can do profiling and testing for that
+
+		// a block chained from pos 0 can't be popped back out of, so walk the chain and release everything
+		while (prevBlock) {
+			ArenaBlock prev = *prevBlock;
+			mem::_release(data, capacity);
+			data = prev.data;
+			capacity = prev.capacity;
+			prevBlock = prev.prev;
+		}
+		mem::_release(data, capacity);
+
+#ifdef TINYDEF_ARENA_STATS
+		stats_unregister(*this);
+#endif
+
+		capacity = 0;
+		data = nullptr;
+	}
+
+	// This function is called "peek", and while it might make sense for it to be called that
+	// It's important to remember that the context of this function is to obtain a memory address
+	// to the next spot that can be allocated at. It's useful if you want to initialize an array
+	// by appending to it (this is a less hacky way of doing "data = Arena::push(1); Arena::pop();")
+	void* Arena::peek() {
+		return static_cast<u8*>(data) + (pos - basePos);
+	}
+
+	// Makes sure everything up to end is committed, rounding up to whole chunks
+	// so the next few pushes won't have to come back here
+	bool Arena::commit_to(size_t end) {
+		// everything below pos is committed already, and on a chained arena
+		// end could be below basePos, which would wrap around into committing the whole block
+		if (end < pos) return true;
+		end -= basePos;
+		if (end <= committed) return true;
+
+		size_t newCommitted = tim::min<size_t>(align_up(end, commitChunk), capacity);
+		if (flags & ARENA_FILE_BACKED) {
+			if (!_resize_file(file, newCommitted)) return false;
+		}
+		else {
+			if (!_commit(static_cast<u8*>(data) + committed, newCommitted - committed)) return false;
+			if (flags & ARENA_PREFAULT) _populate(static_cast<u8*>(data) + committed, newCommitted - committed);
+		}
+
+#ifdef TINYDEF_ARENA_STATS
+		stats.commitCalls++;
+		stats.committedBytes += newCommitted - committed;
+#endif
+
+		committed = newCommitted;
+		lowReleases = 0;
+		return true;
+	}
+
+	// Commits and faults in everything up to end ahead of time, so pushes below it won't page fault.
+	// Meant to be called when a page fault doesn't hurt, e.g. right after alloc with a warm-up size,
+	// or between frames/requests with how much the next one is expected to use
+	void Arena::prefault(size_t end) {
+		// only the part of the current block past pos can be prefaulted
+		end = tim::clamp<size_t>(end, pos, basePos + capacity);
+		if (!commit_to(end)) return;
+
+		size_t from = pos - basePos;
+		if (end - basePos > from) _populate(static_cast<u8*>(data) + from, end - basePos - from);
+	}
+
+	// Returns a pointer to len bytes of memory, or nullptr if the memory couldn't be committed
+	// (or a file backed arena ran out, since a file can't be chained onto)
+	void* Arena::push(size_t len) {
+		if (pos - basePos + len >= capacity) {
+			if (flags & ARENA_FILE_BACKED) return nullptr;
+			assert(flags & ARENA_CHAINED);
+			chain(len);
+		}
+
+		size_t offset = pos - basePos;
+		if (offset + len > committed && !commit_to(pos + len)) return nullptr;
+		pos += len;
+		if (flags & ARENA_FILE_BACKED) static_cast<FileArenaHeader*>(data)->length = pos;
+
+#ifdef TINYDEF_ARENA_STATS
+		stats_push(*this, len);
+#endif
+
+		return static_cast<u8*>(data) + offset;
+	}
+
+	// Pads the arena so the returned pointer is a multiple of align (which has to be a power of two)
+	void* Arena::push_aligned(size_t len, size_t align) {
+		assert(align && (align & (align - 1)) == 0);
+
+		uintptr_t top = reinterpret_cast<uintptr_t>(data) + (pos - basePos);
+		size_t padding = align_up(top, align) - top;
+		if (pos - basePos + padding + len >= capacity) {
+			if (flags & ARENA_FILE_BACKED) return nullptr;
+			assert(flags & ARENA_CHAINED);
+			chain(len + align);
+
+			top = reinterpret_cast<uintptr_t>(data) + (pos - basePos);
+			padding = align_up(top, align) - top;
+		}
+
+		pos += padding;
+		void* result = push(len);
+		if (!result) pos -= padding;
+		return result;
+	}
+
+	// Copies pData into the arena and returns a pointer to it
+	void* Arena::push_data(void* pData, size_t sizeData) {
+		void* result = push(sizeData);
+		if (result) memcpy(result, pData, sizeData);
+		return result;
+	}
+
+	// Returns a pointer to len zero-initialized bytes
+	void* Arena::push_zero(size_t len) {
+		void* result = push(len);
+		if (result) memset(result, 0, len);
+		return result;
+	}
+
+	// Undoes the most recent len bytes of allocation
+	void Arena::pop(size_t len) {
+		pop_to(len > pos ? 0 : pos - len);
+	}
+
+	// Checks if [ptr, ptr + len) is the most recent allocation, so it can be popped
+	bool Arena::is_top(const void* ptr, size_t len) {
+		const u8* bytes = static_cast<const u8*>(ptr);
+		return bytes >= data && bytes + len == peek();
+	}
+
+	// Grows the allocation [ptr, ptr + len) by extra bytes without moving it. This only works
+	// if it's the most recent allocation and there's room left in the current block
+	bool Arena::try_extend(void* ptr, size_t len, size_t extra) {
+		if (!is_top(ptr, len)) return false;
+		if (pos - basePos + extra >= capacity) return false;
+
+		return push(extra) != nullptr;
+	}
+
+	// Instead of deallocating the top x bytes in the arena,
+	// we "cut" the allocated bytes to newPos
+	void Arena::pop_to(size_t newPos) {
+		if (newPos > pos) return;
+
+		// pos only ever goes down through here, so the highest pos seen on the way in
+		// is the most the arena has used since the last time
+		windowPeak = tim::max(windowPeak, pos - basePos);
+
+		// chained blocks that end up completely below newPos get released.
+		// a block that is popped to exactly its start is kept around, otherwise a scope
+		// that straddles the block boundary would reserve and release a block every time
+		while (prevBlock && newPos < prevBlock->startPos) {
+			ArenaBlock prev = *prevBlock;
+			mem::_release(data, capacity);
+
+#ifdef TINYDEF_ARENA_STATS
+			stats.decommitCalls++;
+			stats.committedBytes -= committed;
+#endif
+
+			data = prev.data;
+			capacity = prev.capacity;
+			committed = prev.committed;
+			basePos = prev.basePos;
+			prevBlock = prev.prev;
+
+			windowPeak = capacity;
+		}
+
+		pos = newPos;
+		if (flags & ARENA_FILE_BACKED) static_cast<FileArenaHeader*>(data)->length = pos;
+		if (decommitAfter == 0) return;
+
+		// hysteresis: only decommit after decommitAfter releases in a row where usage
+		// never came within decommitSlack of the committed mark
+		if (align_up(windowPeak + decommitSlack, commitChunk) < committed) {
+			if (++lowReleases >= decommitAfter) {
+				decommit_above(pos + decommitSlack);
+				lowReleases = 0;
+				windowPeak = 0;
+			}
+		}
+		else {
+			lowReleases = 0;
+			windowPeak = 0;
+		}
+	}
+
+	// Lets pop_to (and so ArenaScope) give memory back to the OS. Once afterReleases pops in a row
+	// have happened without the arena getting within slack bytes of its committed mark, everything
+	// past pos + slack is decommitted. The slack keeps a loop that grows and shrinks by about the same
+	// amount from committing and decommitting every time. afterReleases = 0 turns this off (the default)
+	void Arena::set_decommit_policy(size_t slack, u32 afterReleases) {
+		decommitSlack = slack;
+		decommitAfter = afterReleases;
+		lowReleases = 0;
+		windowPeak = 0;
+	}
+
+	// Decommits the current block past end (rounded up to a chunk), the first chunk always stays committed
+	void Arena::decommit_above(size_t end) {
+		size_t keep = tim::max<size_t>(align_up(tim::max(end, pos) - basePos, commitChunk), commitChunk);
+		if (keep >= committed) return;
+
+		u8* start = static_cast<u8*>(data) + keep;
+		if (flags & ARENA_FILE_BACKED) _resize_file(file, keep);
+		else if (flags & ARENA_LAZY_DECOMMIT) _decommit_lazy(start, committed - keep);
+		else _decommit(start, committed - keep);
+
+#ifdef TINYDEF_ARENA_STATS
+		stats.decommitCalls++;
+		stats.committedBytes -= committed - keep;
+#endif
+
+		committed = keep;
+	}
+
+	void Arena::clear() {
+		pop_to(0);
+	}
+
+	// Decommits all memory except the first chunk
+	void Arena::clear_decommit() {
+		clear();
+		decommit_above(0);
+	}
+
+	//
+	// SlabAllocator
+	//
+
+	constexpr size_t SLAB_LARGE_HEADER = align_up(sizeof(SlabAllocator::LargeHeader), 64);
+
+	void SlabAllocator::init(u64 cap) {
+		arena.alloc(cap);
+		memset(classes, 0, sizeof(classes));
+		largeList = nullptr;
+	}
+
+	void SlabAllocator::dealloc() {
+		reset();
+		arena.dealloc();
+	}
+
+	void SlabAllocator::reset() {
+		while (largeList) {
+			LargeHeader* next = largeList->next;
+			_release(largeList, largeList->reserved);
+			largeList = next;
+		}
+
+		memset(classes, 0, sizeof(classes));
+		arena.clear();
+	}
+
+	// Classes 0-7 are 16 to 128 bytes in 16 byte steps. After that every power of two range
+	// (2^p, 2^(p+1)] is split into 4 classes, which keeps the wasted space under 25%
+	u32 SlabAllocator::size_class(size_t size) {
+		if (size <= 128) return size ? static_cast<u32>((size + 15) / 16 - 1) : 0;
+
+		u32 p = tim::log2_floor(size - 1);
+		u32 sub = static_cast<u32>((size - 1 - (1ull << p)) >> (p - 2));
+		return 8 + (p - 7) * 4 + sub;
+	}
+
+	size_t SlabAllocator::class_size(u32 sizeClass) {
+		if (sizeClass < 8) return (sizeClass + 1) * 16;
+
+		u32 p = (sizeClass - 8) / 4 + 7;
+		u32 sub = (sizeClass - 8) % 4;
+		return (1ull << p) + (sub + 1) * (1ull << (p - 2));
+	}
+
+	void* SlabAllocator::alloc(size_t size) {
+		if (size > MAX_SIZE) {
+			size_t reserved = round_to_page_size(size + SLAB_LARGE_HEADER);
+			u8* region = static_cast<u8*>(_reserve(reserved));
+			if (!region || !_commit(region, reserved)) return nullptr;
+
+			LargeHeader* header = reinterpret_cast<LargeHeader*>(region);
+			header->prev = nullptr;
+			header->next = largeList;
+			header->reserved = reserved;
+			header->size = reserved - SLAB_LARGE_HEADER;
+			if (largeList) largeList->prev = header;
+			largeList = header;
+			return region + SLAB_LARGE_HEADER;
+		}
+
+		u32 sizeClass = size_class(size);
+		SizeClass& c = classes[sizeClass];
+		if (c.freeList) {
+			FreeBlock* block = c.freeList;
+			c.freeList = block->next;
+			return block;
+		}
+
+		size_t blockSize = class_size(sizeClass);
+		if (c.bumpPos + blockSize > c.bumpEnd) {
+			u8* slab = static_cast<u8*>(arena.push_aligned(SLAB_SIZE, SLAB_SIZE));
+			*reinterpret_cast<u32*>(slab) = sizeClass;
+			c.bumpPos = slab + SLAB_HEADER;
+			c.bumpEnd = slab + SLAB_SIZE;
+		}
+
+		void* result = c.bumpPos;
+		c.bumpPos += blockSize;
+		return result;
+	}
+
+	// Anything inside the arena came from a slab, everything else is a large allocation
+	void SlabAllocator::free(void* ptr) {
+		if (!ptr) return;
+
+		u8* bytes = static_cast<u8*>(ptr);
+		u8* arenaStart = static_cast<u8*>(arena.data);
+		if (bytes >= arenaStart && bytes < arenaStart + arena.capacity) {
+			u8* slab = reinterpret_cast<u8*>(align_down(reinterpret_cast<uintptr_t>(bytes), SLAB_SIZE));
+			SizeClass& c = classes[*reinterpret_cast<u32*>(slab)];
+
+			FreeBlock* block = static_cast<FreeBlock*>(ptr);
+			block->next = c.freeList;
+			c.freeList = block;
+			return;
+		}
+
+		LargeHeader* header = reinterpret_cast<LargeHeader*>(bytes - SLAB_LARGE_HEADER);
+		if (header->prev) header->prev->next = header->next;
+		else largeList = header->next;
+		if (header->next) header->next->prev = header->prev;
+		_release(header, header->reserved);
+	}
+
+	size_t SlabAllocator::usable_size(void* ptr) {
+		u8* bytes = static_cast<u8*>(ptr);
+		u8* arenaStart = static_cast<u8*>(arena.data);
+		if (bytes >= arenaStart && bytes < arenaStart + arena.capacity) {
+			u8* slab = reinterpret_cast<u8*>(align_down(reinterpret_cast<uintptr_t>(bytes), SLAB_SIZE));
+			return class_size(*reinterpret_cast<u32*>(slab));
+		}
+
+		return reinterpret_cast<LargeHeader*>(bytes - SLAB_LARGE_HEADER)->size;
+	}
+
+	// Stays in place when the new size still fits in the block (the size class, or the pages of a large allocation)
+	void* SlabAllocator::realloc(void* ptr, size_t size) {
+		if (!ptr) return alloc(size);
+		if (size == 0) {
+			free(ptr);
+			return nullptr;
+		}
+
+		size_t oldSize = usable_size(ptr);
+		if (size <= oldSize && (size > MAX_SIZE || size_class(size) == size_class(oldSize))) return ptr;
+
+		void* result = alloc(size);
+		if (result) {
+			memcpy(result, ptr, tim::min(oldSize, size));
+			free(ptr);
+		}
+		return result;
+	}
+
+	//
+	// Snapshots
+	//
+
+	struct SnapshotHeader {
+		u64 magic;
+		u64 size;
+	};
+
+	bool save_snapshot(Arena& arena, const char* path) {
+		// a chained arena isn't one contiguous range, so it can't be written out as one
+		if (arena.prevBlock) return false;
+
+		u8 header[SNAPSHOT_HEADER_SIZE] = {};
+		SnapshotHeader info = { SNAPSHOT_MAGIC, arena.pos };
+		memcpy(header, &info, sizeof(info));
+		// pos 0 isn't at data[0] for a file backed arena (its header page comes first)
+		u8* start = static_cast<u8*>(arena.peek()) - arena.pos;
+		return _write_file(path, header, sizeof(header), start, arena.pos);
+	}
+
+	bool load_snapshot(Snapshot& snapshot, const char* path, bool writable) {
+		snapshot = {};
+
+		size_t fileSize = 0;
+		u8* base = static_cast<u8*>(_map_file(path, writable, &fileSize));
+		if (!base) return false;
+
+		SnapshotHeader info;
+		memcpy(&info, base, sizeof(info));
+		if (fileSize < SNAPSHOT_HEADER_SIZE || info.magic != SNAPSHOT_MAGIC || info.size > fileSize - SNAPSHOT_HEADER_SIZE) {
+			_unmap_file(base, fileSize);
+			return false;
+		}
+
+		snapshot.mapping = base;
+		snapshot.mappingSize = fileSize;
+		snapshot.data = base + SNAPSHOT_HEADER_SIZE;
+		snapshot.size = info.size;
+		return true;
+	}
+
+	void Snapshot::close() {
+		if (mapping) _unmap_file(mapping, mappingSize);
+		*this = {};
+	}
+
+	/* ArenaScope is handy, and the following example might illustrate why:
+	*
+	*	void bingus(i32 someNumber, Arena& arena) {
+	*		ArenaScope arenaScope(arena);
+	*		u8* bytes = arena.push(someNumber);
+	*
+	*		// do something with bytes...
+	*
+	*		// now, at the end of the scope, arenaScope.~ArenaScope() runs and bytes is freed!
+	*	}
+	*/
+	ArenaScope::ArenaScope(Arena& a, bool automatic)
+		: arena(a), releaseOnDestruct(automatic) {
+		startPos = a.pos;
+	}
+
+	ArenaScope::~ArenaScope() {
+		if(releaseOnDestruct)
+			release();
+	}
+
+	void ArenaScope::release() {
+		arena.pop_to(startPos);
+	}
+
+}
+
+#endif